@@ -0,0 +1,149 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// In-process phase timing for the MPI labs.
+//
+// Each program names its phases once, in the same order on every rank:
+//
+//     enum { PHASE_SIEVE, PHASE_MARK, PHASE_COUNT };
+//     static const char* phase_names[] = { "sieve", "mark" };
+//     Metrics m;
+//     metrics_init(&m, "sieve", phase_names, PHASE_COUNT, MPI_COMM_WORLD);
+//     METRICS_PHASE(&m, PHASE_MARK) { mark_base_primes(...); }
+//     metrics_report(&m);
+//
+// metrics_report is collective: per-phase times are reduced to min/max/mean over
+// ranks and rank 0 appends one JSON line to the file named by $METRICS_FILE
+// (nothing is written when it is unset). A NULL Metrics* turns every call into
+// a no-op, so library code can take an optional one.
+
+#define METRICS_MAX_PHASES 16
+#define METRICS_PARAMS_LEN 512
+#define METRICS_ENV "METRICS_FILE"
+
+typedef struct {
+    const char* program;
+    const char* const* names;
+    int n_phases;
+    MPI_Comm comm;
+    double t_start;
+    double started[METRICS_MAX_PHASES];
+    double elapsed[METRICS_MAX_PHASES];
+    long long calls[METRICS_MAX_PHASES];
+    char params[METRICS_PARAMS_LEN];  // "key": value pairs, comma separated
+    size_t params_len;
+} Metrics;
+
+// synchronises comm so the "total" of every rank starts at the same moment
+static inline void metrics_init(Metrics* m, const char* program, const char* const* names,
+                                int n_phases, MPI_Comm comm)
+{
+    memset(m, 0, sizeof(*m));
+    m->program = program;
+    m->names = names;
+    m->n_phases = n_phases < METRICS_MAX_PHASES ? n_phases : METRICS_MAX_PHASES;
+    m->comm = comm;
+
+    MPI_Barrier(comm);
+    m->t_start = MPI_Wtime();
+}
+
+static inline void metrics_start(Metrics* m, int phase)
+{
+    if (m == NULL || phase < 0 || phase >= m->n_phases) return;
+    m->started[phase] = MPI_Wtime();
+}
+
+static inline void metrics_stop(Metrics* m, int phase)
+{
+    if (m == NULL || phase < 0 || phase >= m->n_phases) return;
+    m->elapsed[phase] += MPI_Wtime() - m->started[phase];
+    m->calls[phase]++;
+}
+
+// times the statement or block that follows; leaving it with break, return or
+// goto skips the stop, so use metrics_start/metrics_stop around such code
+#define METRICS_PHASE(m, phase) \
+    for (int metrics_once_ = (metrics_start((m), (phase)), 1); metrics_once_; \
+         metrics_once_ = 0, metrics_stop((m), (phase)))
+
+static inline void metrics_param_raw(Metrics* m, const char* key, const char* json_value)
+{
+    if (m == NULL) return;
+    int written = snprintf(m->params + m->params_len, METRICS_PARAMS_LEN - m->params_len,
+                           "%s\"%s\": %s", m->params_len ? ", " : "", key, json_value);
+    if (written > 0 && m->params_len + (size_t) written < METRICS_PARAMS_LEN)
+        m->params_len += (size_t) written;
+    else
+        m->params[m->params_len] = '\0';
+}
+
+static inline void metrics_param_int(Metrics* m, const char* key, long long value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld", value);
+    metrics_param_raw(m, key, buf);
+}
+
+static inline void metrics_param_str(Metrics* m, const char* key, const char* value)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "\"%s\"", value);
+    metrics_param_raw(m, key, buf);
+}
+
+static inline void metrics_write_stat(FILE* f, const char* name, double min, double max,
+                                      double mean, long long calls, int last)
+{
+    fprintf(f, "\"%s\": {\"min\": %.9f, \"max\": %.9f, \"mean\": %.9f, \"calls\": %lld}%s",
+            name, min, max, mean, calls, last ? "" : ", ");
+}
+
+// collective over the init communicator; the last slot of each reduction is
+// the rank's total time since metrics_init
+static inline void metrics_report(Metrics* m)
+{
+    const int k = m->n_phases;
+    double local[METRICS_MAX_PHASES + 1], t_min[METRICS_MAX_PHASES + 1];
+    double t_max[METRICS_MAX_PHASES + 1], t_sum[METRICS_MAX_PHASES + 1];
+    long long calls[METRICS_MAX_PHASES];
+
+    memcpy(local, m->elapsed, (size_t) k * sizeof(double));
+    local[k] = MPI_Wtime() - m->t_start;
+
+    int rank, size;
+    MPI_Comm_rank(m->comm, &rank);
+    MPI_Comm_size(m->comm, &size);
+
+    MPI_Reduce(local, t_min, k + 1, MPI_DOUBLE, MPI_MIN, 0, m->comm);
+    MPI_Reduce(local, t_max, k + 1, MPI_DOUBLE, MPI_MAX, 0, m->comm);
+    MPI_Reduce(local, t_sum, k + 1, MPI_DOUBLE, MPI_SUM, 0, m->comm);
+    MPI_Reduce(m->calls, calls, k, MPI_LONG_LONG, MPI_MAX, 0, m->comm);
+
+    if (rank != 0) return;
+
+    const char* path = getenv(METRICS_ENV);
+    if (path == NULL || path[0] == '\0') return;
+
+    FILE* f = fopen(path, "a");
+    if (f == NULL)
+    {
+        perror("Error opening metrics file");
+        return;
+    }
+
+    fprintf(f, "{\"program\": \"%s\", \"ranks\": %d, \"params\": {%s}, ", m->program, size, m->params);
+    metrics_write_stat(f, "total", t_min[k], t_max[k], t_sum[k] / size, 1, 0);
+    fprintf(f, "\"phases\": {");
+    for (int i = 0; i < k; i++)
+        metrics_write_stat(f, m->names[i], t_min[i], t_max[i], t_sum[i] / size, calls[i], i == k - 1);
+    fprintf(f, "}}\n");
+    fclose(f);
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+// Optional hardware counters around hot kernels, built only with
+// -DUSE_PERF_COUNTERS on Linux; otherwise every call below is an empty stub.
+//
+//     static PerfCounts mark_perf;              // accumulated over calls
+//     PerfRegion r;
+//     perf_region_open(&r);                     // per thread, counts that thread
+//     perf_region_start(&r);
+//     mark_base_primes(...);
+//     perf_region_stop(&r, &mark_perf);
+//     perf_region_close(&r);
+//     perf_counts_report(&mark_perf, "mark_base_primes", MPI_COMM_WORLD);
+//
+// Events that the kernel or the PMU refuse (e.g. perf_event_paranoid, or no
+// LLC event in a VM) are reported as unavailable instead of failing the run.
+// There is no portable user-space event for DRAM traffic, so bytes are
+// estimated as LLC misses times the cache line size.
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENTS
+};
+
+#define PERF_CACHE_LINE 64
+
+// summed over calls, and over threads when merged
+typedef struct {
+    uint64_t values[PERF_EVENTS];
+    int available[PERF_EVENTS];
+    double seconds;
+    long long calls;
+} PerfCounts;
+
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// unistd.h only declares it for _DEFAULT_SOURCE, which -std=c11 turns off and
+// which is too late to define once the including file has pulled in libc
+extern long syscall(long number, ...);
+
+typedef struct {
+    int leader;
+    int fd[PERF_EVENTS];
+    int slot[PERF_EVENTS];  // position of the event in a group read, -1 if not open
+    int opened;
+    double t_start;
+} PerfRegion;
+
+static inline int perf_open_event(uint32_t type, uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// counts the calling thread on whichever CPU it runs
+static inline void perf_region_open(PerfRegion* r)
+{
+    static const uint64_t configs[PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    memset(r, 0, sizeof(*r));
+    r->leader = -1;
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        r->fd[e] = perf_open_event(PERF_TYPE_HARDWARE, configs[e], r->leader);
+        r->slot[e] = r->fd[e] >= 0 ? r->opened++ : -1;
+        if (r->leader < 0 && r->fd[e] >= 0) r->leader = r->fd[e];
+    }
+}
+
+static inline void perf_region_close(PerfRegion* r)
+{
+    for (int e = PERF_EVENTS - 1; e >= 0; e--)
+        if (r->fd[e] >= 0) close(r->fd[e]);
+    r->leader = -1;
+}
+
+static inline void perf_region_start(PerfRegion* r)
+{
+    r->t_start = MPI_Wtime();
+    if (r->leader < 0) return;
+    ioctl(r->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(r->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// adds this interval to acc, scaled up if the group was multiplexed
+static inline void perf_region_stop(PerfRegion* r, PerfCounts* acc)
+{
+    acc->seconds += MPI_Wtime() - r->t_start;
+    acc->calls++;
+    if (r->leader < 0) return;
+    ioctl(r->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    uint64_t buf[3 + PERF_EVENTS];
+    if (read(r->leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+
+    double scale = buf[2] > 0 ? (double) buf[1] / (double) buf[2] : 0.0;
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (r->slot[e] < 0) continue;
+        acc->values[e] += (uint64_t)((double) buf[3 + r->slot[e]] * scale);
+        acc->available[e] = 1;
+    }
+}
+
+#else
+
+typedef struct {
+    double t_start;
+} PerfRegion;
+
+static inline void perf_region_open(PerfRegion* r) { (void) r; }
+static inline void perf_region_close(PerfRegion* r) { (void) r; }
+static inline void perf_region_start(PerfRegion* r) { (void) r; }
+static inline void perf_region_stop(PerfRegion* r, PerfCounts* acc) { (void) r; (void) acc; }
+
+#endif
+
+static inline void perf_counts_merge(PerfCounts* a, const PerfCounts* b)
+{
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        a->values[e] += b->values[e];
+        a->available[e] |= b->available[e];
+    }
+    a->seconds += b->seconds;
+    a->calls += b->calls;
+}
+
+// collective: counts are summed over ranks, the kernel time is the slowest
+// rank's, which is what bandwidth is achieved against; prints on rank 0.
+// Ranks that never ran the kernel (calls == 0) have nothing to say about the
+// counters, so an event is available if any rank that ran it could count it
+static inline void perf_counts_report(const PerfCounts* c, const char* name, MPI_Comm comm)
+{
+#if defined(USE_PERF_COUNTERS) && defined(__linux__)
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    int local_available[PERF_EVENTS];
+    for (int e = 0; e < PERF_EVENTS; e++)
+        local_available[e] = c->calls > 0 && c->available[e];
+
+    // per rank: 0 did not run the kernel, 1 ran it without counters, 2 counted
+    int state = c->calls > 0 ? 1 + (local_available[PERF_CYCLES] && local_available[PERF_INSTRUCTIONS]) : 0;
+    int* states = rank == 0 ? (int*) malloc((size_t) size * sizeof(int)) : NULL;
+
+    unsigned long long values[PERF_EVENTS];
+    int available[PERF_EVENTS];
+    double seconds;
+    long long calls;
+    MPI_Reduce(c->values, values, PERF_EVENTS, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+    MPI_Reduce(local_available, available, PERF_EVENTS, MPI_INT, MPI_MAX, 0, comm);
+    MPI_Reduce(&c->seconds, &seconds, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&c->calls, &calls, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    MPI_Gather(&state, 1, MPI_INT, states, 1, MPI_INT, 0, comm);
+
+    if (rank != 0) return;
+
+    printf("[perf] %s: %d ranks, %lld calls, %.6f s (slowest rank)\n", name, size, calls, seconds);
+    if (states != NULL)
+    {
+        int ran = 0, counted = 0;
+        printf("[perf]   counters on ranks:");
+        for (int r = 0; r < size; r++)
+        {
+            ran += states[r] > 0;
+            if (states[r] == 2) { printf(" %d", r); counted++; }
+        }
+        printf("%s (%d of %d ranks that ran it)\n", counted ? "" : " none", counted, ran);
+        free(states);
+    }
+    if (!available[PERF_CYCLES] || !available[PERF_INSTRUCTIONS])
+    {
+        printf("[perf]   cycles/instructions unavailable (check perf_event_paranoid)\n");
+        return;
+    }
+    const double per_kilo = values[PERF_INSTRUCTIONS] ? 1000.0 / (double) values[PERF_INSTRUCTIONS] : 0.0;
+    printf("[perf]   cycles %.4e, instructions %.4e, IPC %.3f\n",
+           (double) values[PERF_CYCLES], (double) values[PERF_INSTRUCTIONS],
+           values[PERF_CYCLES] ? (double) values[PERF_INSTRUCTIONS] / values[PERF_CYCLES] : 0.0);
+    if (available[PERF_BRANCH_MISSES])
+        printf("[perf]   branch misses %.4e (%.3f per 1000 instructions)\n",
+               (double) values[PERF_BRANCH_MISSES],
+               values[PERF_BRANCH_MISSES] * per_kilo);
+    if (available[PERF_LLC_MISSES])
+    {
+        double bytes = (double) values[PERF_LLC_MISSES] * PERF_CACHE_LINE;
+        printf("[perf]   LLC misses %.4e (%.3f per 1000 instructions), ~%.3f GB/s from memory\n",
+               (double) values[PERF_LLC_MISSES],
+               values[PERF_LLC_MISSES] * per_kilo,
+               seconds > 0.0 ? bytes / seconds / 1e9 : 0.0);
+    }
+    else
+        printf("[perf]   LLC misses unavailable\n");
+#else
+    (void) c; (void) name; (void) comm;
+#endif
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef SHARED_ALLOC_H
+#define SHARED_ALLOC_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+// both are hidden by -std=c11, which the labs build with
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+extern int madvise(void* addr, size_t length, int advice);
+#endif
+
+// Node-local shared windows split into one segment per rank.
+//
+// Every rank passes the bytes it owns; the segment is zeroed by its owner, so
+// under Linux first-touch its pages land on the owner's NUMA node instead of
+// all on rank 0's. Typed views of any rank's segment come from SHARED_VIEW:
+//
+//     SharedAlloc a;
+//     shared_alloc(&a, shared_comm, my_bytes, SHARED_HUGE_PAGES | SHARED_NONCONTIG);
+//     double* mine = SHARED_VIEW(&a, double, a.rank);
+//     ...
+//     shared_free(&a);
+//
+// By default segments follow each other in rank order, so SHARED_VIEW(&a, T, 0)
+// is one array over the whole window. SHARED_NONCONTIG lets MPI page-align each
+// segment instead (info alloc_shared_noncontig); then only per-rank views are
+// valid, but no page is shared between two owners.
+
+enum {
+    SHARED_CONTIG     = 0,
+    SHARED_NONCONTIG  = 1,  // pad segments to separate pages
+    SHARED_HUGE_PAGES = 2,  // ask for transparent huge pages on the own segment
+};
+
+#define SHARED_CACHE_LINE 64
+#define SHARED_HUGE_PAGE ((size_t) 2 << 20)
+
+#define SHARED_VIEW(a, type, r) ((type*) (a)->base[(r)])
+
+typedef struct {
+    MPI_Win win;
+    MPI_Comm comm;
+    int rank, size;
+    int flags;
+    void** base;     // base[r]: start of rank r's segment
+    size_t* bytes;   // bytes[r]: size of rank r's segment
+} SharedAlloc;
+
+static inline void init_shared_comm(MPI_Comm* shared_comm, int* shared_size, int* shared_rank)
+{
+    MPI_Comm_split_type(
+        MPI_COMM_WORLD,
+        MPI_COMM_TYPE_SHARED,
+        0,
+        MPI_INFO_NULL,
+        shared_comm
+    );
+
+    MPI_Comm_rank(*shared_comm, shared_rank);
+    MPI_Comm_size(*shared_comm, shared_size);
+}
+
+// advice only: shmem huge pages need shmem_enabled=advise or higher, and a
+// refused madvise just leaves the segment on small pages
+static inline void shared_advise_huge(void* ptr, size_t bytes)
+{
+#ifdef __linux__
+    uintptr_t lo = ((uintptr_t) ptr + SHARED_HUGE_PAGE - 1) & ~(uintptr_t)(SHARED_HUGE_PAGE - 1);
+    uintptr_t hi = ((uintptr_t) ptr + bytes) & ~(uintptr_t)(SHARED_HUGE_PAGE - 1);
+    if (hi > lo)
+        madvise((void*) lo, hi - lo, MADV_HUGEPAGE);
+#else
+    (void) ptr; (void) bytes;
+#endif
+}
+
+// collective over comm, which must be a shared-memory communicator; returns 1
+// on success and 0 (with the window left unallocated) on failure
+static inline int shared_alloc(SharedAlloc* a, MPI_Comm comm, size_t bytes, int flags)
+{
+    memset(a, 0, sizeof(*a));
+    a->comm = comm;
+    a->flags = flags;
+    MPI_Comm_rank(comm, &a->rank);
+    MPI_Comm_size(comm, &a->size);
+
+    a->base = (void**) malloc((size_t) a->size * sizeof(void*));
+    a->bytes = (size_t*) malloc((size_t) a->size * sizeof(size_t));
+    if (a->base == NULL || a->bytes == NULL)
+    {
+        perror("Error allocating shared segment table");
+        free(a->base);
+        free(a->bytes);
+        return 0;
+    }
+
+    // keep every noncontiguous segment at least cache-line aligned
+    size_t request = bytes;
+    if (flags & SHARED_NONCONTIG)
+        request = (bytes + SHARED_CACHE_LINE - 1) / SHARED_CACHE_LINE * SHARED_CACHE_LINE;
+
+    MPI_Info info = MPI_INFO_NULL;
+    if (flags & SHARED_NONCONTIG)
+    {
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    }
+
+    void* mybase = NULL;
+    MPI_Win_allocate_shared((MPI_Aint) request, 1, info, comm, &mybase, &a->win);
+    if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+
+    for (int r = 0; r < a->size; r++)
+    {
+        MPI_Aint query_size;
+        int query_disp;
+        MPI_Win_shared_query(a->win, r, &query_size, &query_disp, &a->base[r]);
+        a->bytes[r] = (size_t) query_size;
+    }
+
+    // first touch by the owner
+    if (flags & SHARED_HUGE_PAGES)
+        shared_advise_huge(mybase, request);
+    memset(mybase, 0, request);
+
+    MPI_Win_sync(a->win);
+    MPI_Barrier(comm);
+    return 1;
+}
+
+static inline void shared_free(SharedAlloc* a)
+{
+    MPI_Win_free(&a->win);
+    free(a->base);
+    free(a->bytes);
+    a->base = NULL;
+    a->bytes = NULL;
+}
+
+#endif
@@ -158,57 +158,3 @@ void print_array(const ll* arr, ll size)
     for(ll i = 0; i<size; i++)
         printf("%llu, ", arr[i]);
 }
-
-// ========== SHARED SIEVE HELPERS ==========
-
-void init_shared_comm(MPI_Comm* shared_comm, int* shared_size, int* shared_rank)
-{
-    MPI_Comm_split_type(
-        MPI_COMM_WORLD, 
-        MPI_COMM_TYPE_SHARED, 
-        0,
-        MPI_INFO_NULL, 
-        shared_comm
-    );
-
-    MPI_Comm_rank(*shared_comm, shared_rank);
-    MPI_Comm_size(*shared_comm, shared_size);
-}
-
-void calculate_shared_interval(ll* lowC, ll* lenC, size_t* n_bytes, ll N, ll upper_bound) 
-{
-    *lowC  = upper_bound + 1;
-    *lenC  = N - *lowC + 1;
-    *n_bytes = (size_t)((*lenC + 7) / 8);
-}
-
-void allocate_shared_bitset(MPI_Win* win, MPI_Comm* shared_comm, int shared_rank, size_t n_bytes)
-{
-    bitset_t *mybase = NULL;
-    MPI_Aint winsize = (shared_rank == 0) ? (MPI_Aint) n_bytes : 0;
-    int disp_unit = (int) sizeof(bitset_t);
-    MPI_Win_allocate_shared(
-        winsize, 
-        disp_unit, 
-        MPI_INFO_NULL, 
-        *shared_comm,
-        &mybase, 
-        win
-    );
-}
-
-bitset_t* get_shared_memory_pointer(MPI_Win* win, MPI_Comm* shared_comm, int shared_rank, size_t n_bytes)
-{
-    MPI_Aint query_size;
-    int query_disp;
-    void* baseptr = NULL;
-    MPI_Win_shared_query(*win, 0, &query_size, &query_disp, &baseptr);
-    bitset_t *is_prime_shm = (bitset_t*) baseptr;
-
-    if (shared_rank == 0)
-        memset(is_prime_shm, 0, n_bytes);
-
-    MPI_Win_sync(*win);
-    MPI_Barrier(*shared_comm);
-    return baseptr;
-}
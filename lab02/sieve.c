@@ -1,4 +1,9 @@
 #include "helpers.h"
+#include "../common/metrics.h"
+#include "../common/perf_counters.h"
+
+enum { PHASE_BASE, PHASE_MARK, PHASE_COLLECT, PHASE_GATHER, PHASE_COUNT };
+static const char* phase_names[PHASE_COUNT] = { "base_sieve", "mark", "collect", "gather" };
 
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
@@ -12,6 +17,12 @@ int main(int argc, char** argv) {
     const ll N = 1000000000;
     const ll lower_bound = 2;
     const ll upper_bound = (ll) floor(sqrt(N));
+
+    Metrics metrics;
+    metrics_init(&metrics, "sieve", phase_names, PHASE_COUNT, comm);
+    metrics_param_int(&metrics, "N", (long long) N);
+
+    metrics_start(&metrics, PHASE_BASE);
     bitset_t* is_prime = bitset_calloc(upper_bound + 1);
 
     run_sieve(is_prime, upper_bound);
@@ -21,6 +32,7 @@ int main(int argc, char** argv) {
     ll* base_primes = (ll*) malloc(base_prime_count * sizeof(ll));
     set_primes(is_prime, upper_bound, base_primes, 0);
     free(is_prime);
+    metrics_stop(&metrics, PHASE_BASE);
 
     // decompose domain C = [upper_bound+1, N]
     ll low = 0, high = 0;
@@ -29,17 +41,29 @@ int main(int argc, char** argv) {
     // local sieve
     ll local_len = high - low + 1;
     bitset_t* is_prime_local = bitset_calloc(local_len);
-    mark_base_primes(is_prime_local, base_primes, base_prime_count, low, high);
+    PerfCounts mark_perf = {0};
+    PerfRegion perf;
+    perf_region_open(&perf);
+    METRICS_PHASE(&metrics, PHASE_MARK)
+    {
+        perf_region_start(&perf);
+        mark_base_primes(is_prime_local, base_primes, base_prime_count, low, high);
+        perf_region_stop(&perf, &mark_perf);
+    }
+    perf_region_close(&perf);
 
     // collect local primes
+    metrics_start(&metrics, PHASE_COLLECT);
     ll local_prime_count = count_primes(is_prime_local, local_len - 1);
     int local_count_i = (int) local_prime_count;
 
     ll* local_primes = (ll*) malloc(local_prime_count * sizeof(ll));
     set_primes(is_prime_local, local_len - 1, local_primes, low);
     free(is_prime_local);
+    metrics_stop(&metrics, PHASE_COLLECT);
 
     // counts holds amount of primes computed in each thread
+    metrics_start(&metrics, PHASE_GATHER);
     int* counts = gather_local_counts(local_count_i, rank, size);
 
     // find total number of primes and memory displacement array
@@ -48,6 +72,7 @@ int main(int argc, char** argv) {
 
     // gather the actual primes into root
     ll* all_c_primes = gather_primes(local_primes, local_prime_count, counts, displs, total_c_count, rank);
+    metrics_stop(&metrics, PHASE_GATHER);
 
     int base_count_int = (int) base_prime_count;
     int total_primes = base_count_int + total_c_count;
@@ -59,5 +84,7 @@ int main(int argc, char** argv) {
         printf("Total primes in [2..%llu]: %d\n", N, total_primes);
     }
 
+    metrics_report(&metrics);
+    perf_counts_report(&mark_perf, "mark_base_primes", comm);
     MPI_Finalize();
 }
\ No newline at end of file
@@ -1,4 +1,10 @@
 #include "helpers.h"
+#include "../common/metrics.h"
+#include "../common/shared_alloc.h"
+#include "../common/perf_counters.h"
+
+enum { PHASE_BASE, PHASE_ALLOC, PHASE_MARK, PHASE_SYNC, PHASE_COLLECT, PHASE_COUNT };
+static const char* phase_names[PHASE_COUNT] = { "base_sieve", "alloc", "mark", "sync", "collect" };
 
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
@@ -19,7 +25,13 @@ int main(int argc, char** argv) {
     const ll lower_bound = 2;
     const ll upper_bound = (ll) floor(sqrt(N));
 
+    Metrics metrics;
+    metrics_init(&metrics, "sieve_shared", phase_names, PHASE_COUNT, comm);
+    metrics_param_int(&metrics, "N", (long long) N);
+    metrics_param_int(&metrics, "node_ranks", shared_size);
+
     // make is_prime lookup, is_prime[k] = 0 => k is prime
+    metrics_start(&metrics, PHASE_BASE);
     bitset_t* is_prime = bitset_calloc(upper_bound + 1);
     run_sieve(is_prime, upper_bound);
 
@@ -28,42 +40,69 @@ int main(int argc, char** argv) {
     ll* base_primes = (ll*) malloc(base_prime_count * sizeof(ll));
     set_primes(is_prime, upper_bound, base_primes, 0);
     free(is_prime);
-
-    // calculate parameters of interval C = [upper_bound+1, N]
-    ll lowC, lenC;
-    size_t n_bytes;
-    calculate_shared_interval(&lowC, &lenC, &n_bytes, N, upper_bound);
-
-    // allocate shared memory window
-    MPI_Win win;
-    allocate_shared_bitset(&win, &shared_comm, shared_rank, n_bytes);
-
-    // get the pointer to shared memory in each process
-    bitset_t* is_prime_shared = get_shared_memory_pointer(&win, &shared_comm, shared_rank, n_bytes);
+    metrics_stop(&metrics, PHASE_BASE);
 
     // decompose domain C = [upper_bound+1, N]
+    const ll lowC = upper_bound + 1;
     ll low, high;
     block_decompose(world_rank, world_size, upper_bound, N, &low, &high);
+    ll local_len = high - low + 1;
+
+    // every rank owns the bitset of its block in its own page-aligned segment,
+    // so neighbours never write the same byte and the pages are first-touched
+    // on the owner's NUMA node
+    metrics_start(&metrics, PHASE_ALLOC);
+    SharedAlloc shared;
+    shared_alloc(&shared, shared_comm, (size_t)((local_len + 7) / 8), SHARED_NONCONTIG | SHARED_HUGE_PAGES);
+    bitset_t* is_prime_seg = SHARED_VIEW(&shared, bitset_t, shared_rank);
+    metrics_stop(&metrics, PHASE_ALLOC);
 
     // local sieve
-    ll local_len = high - low + 1;
-    bitset_t *is_prime_seg = is_prime_shared + BIT_INDEX((size_t)(low - lowC));
-    mark_base_primes(is_prime_seg, base_primes, base_prime_count, low, high);
+    PerfCounts mark_perf = {0};
+    PerfRegion perf;
+    perf_region_open(&perf);
+    METRICS_PHASE(&metrics, PHASE_MARK)
+    {
+        perf_region_start(&perf);
+        mark_base_primes(is_prime_seg, base_primes, base_prime_count, low, high);
+        perf_region_stop(&perf, &mark_perf);
+    }
+    perf_region_close(&perf);
 
     // publish local writes
-    MPI_Win_sync(win);
-    MPI_Barrier(shared_comm);
+    METRICS_PHASE(&metrics, PHASE_SYNC)
+    {
+        MPI_Win_sync(shared.win);
+        MPI_Barrier(shared_comm);
+    }
 
     int base_count_int = (int) base_prime_count;
     int single_node = (shared_size == world_size);
 
     if (single_node) {
-        // Everyone is on one node -> rank 0 can walk the entire shared bitset
-        ll c_prime_count = count_primes(is_prime_shared, lenC - 1);
+        // Everyone is on one node -> each rank can walk every segment, in rank order
+        metrics_start(&metrics, PHASE_COLLECT);
+        ll c_prime_count = 0;
+        ll* seg_low = (ll*) malloc((size_t)shared_size * sizeof(ll));
+        ll* seg_high = (ll*) malloc((size_t)shared_size * sizeof(ll));
+        ll* seg_count = (ll*) malloc((size_t)shared_size * sizeof(ll));
+        for (int r = 0; r < shared_size; r++) {
+            block_decompose(r, world_size, upper_bound, N, &seg_low[r], &seg_high[r]);
+            seg_count[r] = count_primes(SHARED_VIEW(&shared, bitset_t, r), seg_high[r] - seg_low[r]);
+            c_prime_count += seg_count[r];
+        }
         int total_primes = base_count_int + (int) c_prime_count;
 
         ll *all_c_primes = (ll*) malloc((size_t)c_prime_count * sizeof(ll));
-        set_primes(is_prime_shared, lenC - 1, all_c_primes, lowC);
+        ll k = 0;
+        for (int r = 0; r < shared_size; r++) {
+            set_primes(SHARED_VIEW(&shared, bitset_t, r), seg_high[r] - seg_low[r], all_c_primes + k, seg_low[r]);
+            k += seg_count[r];
+        }
+        free(seg_low);
+        free(seg_high);
+        free(seg_count);
+        metrics_stop(&metrics, PHASE_COLLECT);
 
         if (world_rank == 0) {
             printf("n = %llu\n", N);
@@ -74,7 +113,10 @@ int main(int argc, char** argv) {
         free(all_c_primes);
     }
 
-    MPI_Win_free(&win);
+    metrics_report(&metrics);
+    perf_counts_report(&mark_perf, "mark_base_primes", comm);
+
+    shared_free(&shared);
     MPI_Comm_free(&shared_comm);
     MPI_Finalize();
     return 0;
@@ -1,24 +1,39 @@
+import json
 import os
-import time
 import subprocess
+import tempfile
 import matplotlib.pyplot as plt
 
-def time_once(cmd):
-    t0 = time.perf_counter()
-    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
-    return time.perf_counter() - t0
+# jacobi reports its own per-phase times (common/metrics.h), so launcher startup
+# is not part of the numbers; the slowest rank defines each phase's time
+def run_once(cmd):
+    with tempfile.NamedTemporaryFile(suffix=".jsonl", delete=False) as f:
+        metrics_file = f.name
+    try:
+        env = dict(os.environ, METRICS_FILE=metrics_file)
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, env=env)
+        with open(metrics_file) as f:
+            record = json.loads(f.readlines()[-1])
+    finally:
+        os.remove(metrics_file)
+
+    times = {"total": record["total"]["max"]}
+    times.update({name: stat["max"] for name, stat in record["phases"].items()})
+    return times
 
 def build_cmd(process_count, grid_size):
     return ["mpiexec", "-n", str(process_count), "./jacobi", str(grid_size)]
 
 def bench_grid(grid_size, thread_counts, repeats):
-    means = []
+    means = {}
 
     for p in thread_counts:
-        runs = [time_once(build_cmd(p, grid_size)) for _ in range(repeats)]
-        mean = sum(runs) / repeats
-        means.append(mean)
-        print(f"N={grid_size}, p={p}: runs={', '.join(f'{r:.3f}s' for r in runs)} | mean={mean:.3f}s")
+        runs = [run_once(build_cmd(p, grid_size)) for _ in range(repeats)]
+        for phase in runs[0]:
+            means.setdefault(phase, []).append(sum(r[phase] for r in runs) / repeats)
+        totals = ", ".join(f"{r['total']:.3f}s" for r in runs)
+        phases = ", ".join(f"{phase}={means[phase][-1]:.3f}s" for phase in means)
+        print(f"N={grid_size}, p={p}: runs={totals} | mean {phases}")
 
     return means
 
@@ -29,9 +44,9 @@ def compute_metrics(runtimes_by_grid, thread_counts):
     for N, means in runtimes_by_grid.items():
 
         T1 = means[0]
-        s = [T1 / m for m in means]                                  # Speedup
+        s = [T1 / m if m > 0 else 0.0 for m in means]               # Speedup
         e = [si / p for si, p in zip(s, thread_counts)]              # Efficiency
-        k = [(1.0/si - 1.0/p) / (1.0 - 1.0/p)
+        k = [(1.0/si - 1.0/p) / (1.0 - 1.0/p) if si > 0 else 0.0
              for si, p in zip(s[1:], thread_counts[1:])]             # Karp–Flatt (p > 1)
         
         speedup_by_grid[N] = s
@@ -39,17 +54,17 @@ def compute_metrics(runtimes_by_grid, thread_counts):
         karp_by_grid[N] = k
     return speedup_by_grid, efficiency_by_grid, karp_by_grid
 
-def plot_lines(y_by_grid, thread_counts, title, y_label, out_file, karp=False, repeats=1):
+def plot_lines(y_by_grid, thread_counts, title, y_label, out_file, karp=False, repeats=1, legend="Grid size"):
     plt.figure(figsize=(8, 5))
 
     for N, ys in sorted(y_by_grid.items()):
         xs = thread_counts[1:] if karp else thread_counts
-        plt.plot(xs, ys if not karp else ys, marker="o", label=f"N={N}")
+        plt.plot(xs, ys if not karp else ys, marker="o", label=f"N={N}" if legend == "Grid size" else N)
 
     plt.xlabel("Thread count (processes)")
     plt.ylabel(f"{y_label} (avg of {repeats} runs)")
     plt.title(title)
-    plt.legend(title="Grid size")
+    plt.legend(title=legend)
     
     plt.tight_layout()
     os.makedirs(os.path.dirname(out_file), exist_ok=True)
@@ -61,8 +76,9 @@ def main():
     THREAD_COUNTS = [1, 2, 4, 6, 8]
     REPEATS       = 3
 
-    # 1) collect runtimes
-    runtimes_by_grid = {N: bench_grid(N, THREAD_COUNTS, REPEATS) for N in GRID_SIZES}
+    # 1) collect per-phase runtimes, "total" is the in-process wall time
+    phases_by_grid = {N: bench_grid(N, THREAD_COUNTS, REPEATS) for N in GRID_SIZES}
+    runtimes_by_grid = {N: phases["total"] for N, phases in phases_by_grid.items()}
 
     # 2) plot runtime (one line per grid size)
     plot_lines(
@@ -111,5 +127,29 @@ def main():
         repeats=REPEATS
     )
 
+    # 7) per-phase speedup and Karp–Flatt, one figure per grid size
+    for N, phases in phases_by_grid.items():
+        phase_speedup, _, phase_karp = compute_metrics(phases, THREAD_COUNTS)
+        plot_lines(
+            y_by_grid=phase_speedup,
+            thread_counts=THREAD_COUNTS,
+            title=f"Per-phase speedup vs thread count (N={N})",
+            y_label="Speedup (T1/Tp)",
+            out_file=f"data/benchmarks/phase_speedup_{N}.png",
+            karp=False,
+            repeats=REPEATS,
+            legend="Phase"
+        )
+        plot_lines(
+            y_by_grid=phase_karp,
+            thread_counts=THREAD_COUNTS,
+            title=f"Per-phase Karp–Flatt metric vs thread count (N={N})",
+            y_label="Karp–Flatt ε",
+            out_file=f"data/benchmarks/phase_karp_flatt_{N}.png",
+            karp=True,
+            repeats=REPEATS,
+            legend="Phase"
+        )
+
 if __name__ == "__main__":
     main()
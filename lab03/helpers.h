@@ -19,7 +19,7 @@ static inline void parse_and_brodcast(int* N, int world_rank, char** argv, MPI_C
         *N = (int) strtol(argv[1], &end, 10);
     }
 
-    MPI_Bcast(&N, 1, MPI_INT, 0, comm);
+    MPI_Bcast(N, 1, MPI_INT, 0, comm);
 }
 
 static inline int verify_args(int world_rank, int world_size) 
@@ -33,51 +33,6 @@ static inline int verify_args(int world_rank, int world_size)
     return 1;
 }
 
-static inline void init_shared_comm(MPI_Comm* shared_comm, int* shared_size, int* shared_rank)
-{
-    MPI_Comm_split_type(
-        MPI_COMM_WORLD, 
-        MPI_COMM_TYPE_SHARED, 
-        0,
-        MPI_INFO_NULL, 
-        shared_comm
-    );
-
-    MPI_Comm_rank(*shared_comm, shared_rank);
-    MPI_Comm_size(*shared_comm, shared_size);
-}
-
-static inline void allocate_shared_memory(MPI_Win* win, MPI_Comm* shared_comm, int shared_rank, size_t n_bytes)
-{
-    double* mybase = NULL;
-    MPI_Aint winsize = (shared_rank == 0) ? (MPI_Aint) n_bytes : 0;
-    int disp_unit = (int) sizeof(double);
-    MPI_Win_allocate_shared(
-        winsize, 
-        disp_unit, 
-        MPI_INFO_NULL, 
-        *shared_comm,
-        &mybase, 
-        win
-    );
-}
-
-static inline double* get_shared_memory_pointer(MPI_Win* win, MPI_Comm* shared_comm, int shared_rank, size_t n_bytes)
-{
-    MPI_Aint query_size;
-    int query_disp;
-    void* baseptr = NULL;
-    MPI_Win_shared_query(*win, 0, &query_size, &query_disp, &baseptr);
-
-    // zero the entire region
-    if (shared_rank == 0)
-        memset(baseptr, 0, n_bytes);
-
-    MPI_Win_sync(*win);
-    MPI_Barrier(*shared_comm);
-    return (double *)baseptr;
-}
-
 // split [1..N-2] interior among p parts -> [start,end) in interior indices
 static inline void split_1d_interior(int N, int p, int idx, int *start, int *end) {
     const int interior = N - 2;
@@ -111,6 +66,32 @@ static inline void block_decompose(int world_rank, int world_size, int N,
     split_1d_interior(N, p_cols, col, sj, ej);
 }
 
+// rows of the grid whose pages a node rank first-touches: the interior rows of
+// each 2-row band of block_decompose are split between the ranks of that band,
+// and rank 0 / the last rank also take the boundary rows, so consecutive
+// ranks own consecutive rows and every rank touches rows it updates
+static inline void owned_rows(int rank, int size, int N, int *r0, int *r1) {
+    if (size == 1) {
+        *r0 = 0;
+        *r1 = N;
+        return;
+    }
+
+    const int p_cols = size / 2;
+    int si, ei;
+    split_1d_interior(N, 2, rank / p_cols, &si, &ei);
+
+    const int band = ei - si;
+    const int col  = rank % p_cols;
+    const int base = band / p_cols;
+    const int rem  = band % p_cols;
+    *r0 = si + col * base + (col < rem ? col : rem);
+    *r1 = *r0 + base + (col < rem ? 1 : 0);
+
+    if (rank == 0)        *r0 = 0;
+    if (rank == size - 1) *r1 = N;
+}
+
 // local L2 sum over a block
 static inline double local_residual(const double *X, const double *Y, int N, 
                                     int si, int sj, int ei, int ej) {
@@ -1,18 +1,22 @@
 #include "helpers.h"
+#include "../common/metrics.h"
+#include "../common/shared_alloc.h"
+#include "../common/perf_counters.h"
 
 #define x(i, j) X[(i)*(N) + (j)]
 #define y(i, j) X_new[(i)*(N) + (j)]
 
+enum { PHASE_ALLOC, PHASE_UPDATE, PHASE_SYNC, PHASE_RESIDUAL, PHASE_COUNT };
+static const char* phase_names[PHASE_COUNT] = { "alloc", "update", "sync", "residual" };
+
 int main(int argc, char** argv){
     MPI_Init(&argc, &argv);
 
     int N            = -1;             // grid size
     const int T      = 20000;          // max iteration count
     const int report = 1000;           // check norm every
-    const double h   = 1.0/(double)N;  // grid spacing (normalised to grid 1x1)
     const double g   = 1.0;            // g constant
     const double lam = 1.0;            // lambda
-    const double C   = h*h * (g/lam);  // collapsed constant for Jacobi update
     const double eps = 1e-5;           // L2 tolerance on difference between iterates
     const int save   = 0;              // 1 - save solution to file, 0 - don't save
 
@@ -24,6 +28,9 @@ int main(int argc, char** argv){
     // parse and broadcast N
     parse_and_brodcast(&N, world_rank, argv, comm);
 
+    const double h   = 1.0/(double)N;  // grid spacing (normalised to grid 1x1)
+    const double C   = h*h * (g/lam);  // collapsed constant for Jacobi update
+
     // check if world_size % 2 == 0
     if (!verify_args(world_rank, world_size))
     {
@@ -31,20 +38,28 @@ int main(int argc, char** argv){
         return EXIT_FAILURE;
     }
 
+    Metrics metrics;
+    metrics_init(&metrics, "jacobi", phase_names, PHASE_COUNT, comm);
+    metrics_param_int(&metrics, "N", N);
+
     // initialized communicator per node
+    metrics_start(&metrics, PHASE_ALLOC);
     MPI_Comm shared_comm;
     int shared_rank, shared_size;
     init_shared_comm(&shared_comm, &shared_size, &shared_rank);
 
-    // allocate two one continous memory space of size 2 * N^2 for arrays X and X_new
-    MPI_Win win;
-    const MPI_Aint bytes_total = (size_t)(2 * N * N * sizeof(double));
-    allocate_shared_memory(&win, &shared_comm, shared_rank, bytes_total);
+    // X and X_new are contiguous windows of N^2 doubles, each rank owning (and
+    // first-touching) a band of rows it updates, so its pages stay NUMA-local
+    int row_lo, row_hi;
+    owned_rows(shared_rank, shared_size, N, &row_lo, &row_hi);
+    const size_t bytes_owned = (size_t)(row_hi - row_lo) * (size_t) N * sizeof(double);
 
-    // get the pointer to shared memory in each process and assign to X and X_new with offset
-    double* base = get_shared_memory_pointer(&win, &shared_comm, shared_rank, bytes_total);
-    double* X = base;
-    double* X_new = base + N * N;  // N^2 offset
+    SharedAlloc x_alloc, x_new_alloc;
+    shared_alloc(&x_alloc, shared_comm, bytes_owned, SHARED_CONTIG | SHARED_HUGE_PAGES);
+    shared_alloc(&x_new_alloc, shared_comm, bytes_owned, SHARED_CONTIG | SHARED_HUGE_PAGES);
+    double* X = SHARED_VIEW(&x_alloc, double, 0);
+    double* X_new = SHARED_VIEW(&x_new_alloc, double, 0);
+    metrics_stop(&metrics, PHASE_ALLOC);
 
     // blocks are defined as (start_i, start_j) - (end_i, end_j), find them for each process
     int start_i, start_j, end_i, end_j;
@@ -53,9 +68,14 @@ int main(int argc, char** argv){
     // main loop
     double *tmp;
     int stop = 0;
+    PerfCounts update_perf = {0};
+    PerfRegion perf;
+    perf_region_open(&perf);
     for(int t=0; t<T; t++)
     {   
         // update values
+        metrics_start(&metrics, PHASE_UPDATE);
+        perf_region_start(&perf);
         for(int i=start_i; i<end_i; i++)
         {
             for(int j=start_j; j<end_j; j++)
@@ -63,12 +83,19 @@ int main(int argc, char** argv){
                 y(i, j) = 0.25 * (x(i + 1, j) + x(i - 1, j) + x(i, j + 1) + x(i, j - 1) + C); 
             }
         }
+        perf_region_stop(&perf, &update_perf);
+        metrics_stop(&metrics, PHASE_UPDATE);
         
         // sync
-        MPI_Win_sync(win);
-        MPI_Barrier(shared_comm);
+        METRICS_PHASE(&metrics, PHASE_SYNC)
+        {
+            MPI_Win_sync(x_alloc.win);
+            MPI_Win_sync(x_new_alloc.win);
+            MPI_Barrier(shared_comm);
+        }
         
         // every 10 iteration check L2 norm between X and X_new, only on root
+        metrics_start(&metrics, PHASE_RESIDUAL);
         if (t % report == 0)
         {
             double local = local_residual(X, X_new, N, start_i, start_j, end_i, end_j);
@@ -84,6 +111,7 @@ int main(int argc, char** argv){
         
         // send the value of stop to each thread
         MPI_Bcast(&stop, 1, MPI_INT, 0, comm);
+        metrics_stop(&metrics, PHASE_RESIDUAL);
         if (stop) break;
 
         // swap pointers
@@ -92,15 +120,22 @@ int main(int argc, char** argv){
         X_new = tmp;
 
         // ensure swap
-        MPI_Barrier(shared_comm);
+        METRICS_PHASE(&metrics, PHASE_SYNC)
+            MPI_Barrier(shared_comm);
     }
 
+    metrics_param_int(&metrics, "iterations", metrics.calls[PHASE_UPDATE]);
+    perf_region_close(&perf);
+    metrics_report(&metrics);
+    perf_counts_report(&update_perf, "jacobi_update", comm);
+
     if (save == 1 && world_rank == 0) {
         write_to_file("data/grids/grid_1024.bin", X, N);
         printf("Done");
     }
 
-    MPI_Win_free(&win);
+    shared_free(&x_alloc);
+    shared_free(&x_new_alloc);
     MPI_Comm_free(&shared_comm);
     MPI_Finalize();
     return 0;
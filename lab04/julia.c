@@ -0,0 +1,240 @@
+#define _POSIX_C_SOURCE 199309L
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "julia.h"
+
+#define ENABLE_SLEEP 1
+#define SLEEP_LINE 1
+#define SLEEP_TIME 2.0
+
+#define TAG_WORK 1
+#define TAG_RESULT 2
+#define TAG_STOP 3
+
+#define GUIDED_FACTOR 2  // chunk = remaining / (GUIDED_FACTOR * workers)
+#define MIN_CHUNK 1
+#define MAX_CHUNK 64
+
+static void sleep_seconds(double s)
+{
+    struct timespec ts = { (time_t) s, (long)((s - (time_t) s) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+// render lines [first, first+count) into pixels, per-line times into times
+static void render_lines(int rank, int first, int count, uint8_t* pixels, double* times, const JuliaParams* p)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int k = first + i;
+        double t_start = MPI_Wtime();
+        julia_row(&pixels[(size_t) i * p->w], k, 0, p->w, p);
+        double t_line = MPI_Wtime() - t_start;
+
+        if (ENABLE_SLEEP && k == SLEEP_LINE)
+        {
+            printf("[rank %d] linia %d: usypiam na %.3f s\n", rank, k, SLEEP_TIME);
+            sleep_seconds(SLEEP_TIME);
+            t_line += SLEEP_TIME;
+        }
+
+        printf("[rank %d] linia %d: czas = %.6f s\n", rank, k, t_line);
+        times[i] = t_line;
+    }
+}
+
+// guided self-scheduling: large chunks first, single lines at the tail, so a
+// straggling line only ever holds back the chunk it sits in
+static int next_chunk(int remaining, int workers)
+{
+    int chunk = remaining / (GUIDED_FACTOR * workers);
+    if (chunk < MIN_CHUNK) chunk = MIN_CHUNK;
+    if (chunk > MAX_CHUNK) chunk = MAX_CHUNK;
+    if (chunk > remaining) chunk = remaining;
+    return chunk;
+}
+
+// result message: count line times followed by count rows of pixels
+static size_t result_bytes(int count, const JuliaParams* p)
+{
+    return (size_t) count * (sizeof(double) + (size_t) p->w);
+}
+
+void worker(int rank, const JuliaParams* p)
+{
+    char* buf = (char*) malloc(result_bytes(MAX_CHUNK, p));
+    int work[2];
+    MPI_Status status;
+
+    while (1)
+    {
+        MPI_Recv(work, 2, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (status.MPI_TAG == TAG_STOP) break;
+
+        double* times = (double*) buf;
+        uint8_t* pixels = (uint8_t*)(buf + (size_t) work[1] * sizeof(double));
+        render_lines(rank, work[0], work[1], pixels, times, p);
+
+        MPI_Send(buf, (int) result_bytes(work[1], p), MPI_BYTE, 0, TAG_RESULT, MPI_COMM_WORLD);
+    }
+    free(buf);
+}
+
+void master(int workers, const JuliaParams* p, uint8_t* image, double* line_times, int* line_rank)
+{
+    if (workers == 0)
+    {
+        render_lines(0, 0, p->h, image, line_times, p);
+        for (int k = 0; k < p->h; k++) line_rank[k] = 0;
+        return;
+    }
+
+    char* buf = (char*) malloc(result_bytes(MAX_CHUNK, p));
+    int* assigned = (int*) malloc(2 * (size_t)(workers + 1) * sizeof(int));
+    int next_line = 0;
+    int active = 0;
+
+    for (int w = 1; w <= workers; w++)
+    {
+        int count = next_chunk(p->h - next_line, workers);
+        if (count == 0)
+        {
+            MPI_Send(NULL, 0, MPI_INT, w, TAG_STOP, MPI_COMM_WORLD);
+            continue;
+        }
+        assigned[2 * w] = next_line;
+        assigned[2 * w + 1] = count;
+        MPI_Send(&assigned[2 * w], 2, MPI_INT, w, TAG_WORK, MPI_COMM_WORLD);
+        next_line += count;
+        active++;
+    }
+
+    while (active > 0)
+    {
+        MPI_Status status;
+        MPI_Recv(buf, (int) result_bytes(MAX_CHUNK, p), MPI_BYTE, MPI_ANY_SOURCE, TAG_RESULT, MPI_COMM_WORLD, &status);
+
+        int w = status.MPI_SOURCE;
+        int first = assigned[2 * w], count = assigned[2 * w + 1];
+        memcpy(&line_times[first], buf, (size_t) count * sizeof(double));
+        memcpy(&image[(size_t) first * p->w], buf + (size_t) count * sizeof(double), (size_t) count * p->w);
+        for (int k = first; k < first + count; k++) line_rank[k] = w;
+
+        count = next_chunk(p->h - next_line, workers);
+        if (count > 0)
+        {
+            assigned[2 * w] = next_line;
+            assigned[2 * w + 1] = count;
+            MPI_Send(&assigned[2 * w], 2, MPI_INT, w, TAG_WORK, MPI_COMM_WORLD);
+            next_line += count;
+        }
+        else
+        {
+            MPI_Send(NULL, 0, MPI_INT, w, TAG_STOP, MPI_COMM_WORLD);
+            active--;
+        }
+    }
+
+    free(buf);
+    free(assigned);
+}
+
+// same report as julia.py
+void print_statistics(const JuliaParams* p, const double* line_times, const int* line_rank,
+                      int size, double total_program_time)
+{
+    double min_time = line_times[0], max_time = line_times[0], sum_time = 0.0;
+    for (int k = 0; k < p->h; k++)
+    {
+        if (line_times[k] < min_time) min_time = line_times[k];
+        if (line_times[k] > max_time) max_time = line_times[k];
+        sum_time += line_times[k];
+    }
+
+    printf("\n== Statystyki czasów linii (pkt 2) ==\n");
+    printf("min: %.6f s\n", min_time);
+    printf("max: %.6f s\n", max_time);
+    printf("różnica (max - min): %.6f s\n", max_time - min_time);
+
+    printf("\n== Przypisanie linii do procesów (pkt 3) ==\n");
+    printf("Pierwsze 50 linii:\n");
+    for (int k = 0; k < 50 && k < p->h; k++)
+        printf("linia %4d -> rank %d\n", k, line_rank[k]);
+
+    int* lines_per_rank = (int*) calloc((size_t) size, sizeof(int));
+    double* time_per_rank = (double*) calloc((size_t) size, sizeof(double));
+    for (int k = 0; k < p->h; k++)
+    {
+        lines_per_rank[line_rank[k]]++;
+        time_per_rank[line_rank[k]] += line_times[k];
+    }
+
+    printf("\n== Liczba linii na każdy proces (pkt 4) ==\n");
+    for (int r = 0; r < size; r++)
+        if (lines_per_rank[r] > 0)
+            printf("rank %d: %d linii\n", r, lines_per_rank[r]);
+
+    printf("\n== Suma czasów linii na każdy proces (pkt 5) ==\n");
+    for (int r = 0; r < size; r++)
+        if (lines_per_rank[r] > 0)
+            printf("rank %d: %.6f s\n", r, time_per_rank[r]);
+
+    printf("\n== Czas całego programu (pkt 5) ==\n");
+    printf("całkowity czas programu (od startu do końca obliczeń): %.6f s\n", total_program_time);
+
+    printf("\nSuma czasów wszystkich linii (dla porównania): %.6f s\n", sum_time);
+
+    free(lines_per_rank);
+    free(time_per_rank);
+}
+
+// build: mpicc -std=c11 -O3 -mavx2 -ffp-contract=off julia.c -o julia
+// run:   mpiexec -n 5 ./julia   (rank 0 only schedules lines and writes julia.pgm)
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    JuliaParams p = julia_default_params();
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_program_start = MPI_Wtime();
+
+    if (rank == 0)
+    {
+        uint8_t* image = (uint8_t*) malloc((size_t) p.w * p.h);
+        double* line_times = (double*) malloc((size_t) p.h * sizeof(double));
+        int* line_rank = (int*) malloc((size_t) p.h * sizeof(int));
+
+        master(size - 1, &p, image, line_times, line_rank);
+        double total_program_time = MPI_Wtime() - t_program_start;
+
+        FILE* f = fopen("julia.pgm", "wb");
+        if (f == NULL)
+            perror("Error opening julia.pgm");
+        else
+        {
+            write_pgm_header(f, p.w, p.h);
+            fwrite(image, 1, (size_t) p.w * p.h, f);
+            fclose(f);
+        }
+
+        print_statistics(&p, line_times, line_rank, size, total_program_time);
+
+        free(image);
+        free(line_times);
+        free(line_rank);
+    }
+    else
+        worker(rank, &p);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#ifndef JULIA_H
+#define JULIA_H
+
+#include <stdint.h>
+#include <stdio.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define MAX_ESCAPE 255
+#define ESCAPE_RADIUS_SQ 9.0  // |z| < 3
+
+// same view and constant as julia.py
+typedef struct {
+    double x0, x1, y0, y1;
+    int w, h;
+    double dx, dy;
+    double cr, ci;
+} JuliaParams;
+
+// resample the same view at w x h pixels
+static inline void julia_set_size(JuliaParams* p, int w, int h)
+{
+    p->w = w;
+    p->h = h;
+    p->dx = (p->x1 - p->x0) / w;
+    p->dy = (p->y1 - p->y0) / h;
+}
+
+static inline JuliaParams julia_default_params(void)
+{
+    JuliaParams p = {
+        .x0 = -2.0, .x1 = 2.0, .y0 = -1.5, .y1 = 1.5,
+        .cr = 0.0, .ci = 0.65
+    };
+    julia_set_size(&p, 640 * 2, 480 * 2);
+    return p;
+}
+
+// escape count exactly as julia.py: start at 255, decrement while |z| < 3 and n > 1
+static inline uint8_t julia_pixel(double x, double y, double cr, double ci)
+{
+    double zr = x, zi = y;
+    int n = MAX_ESCAPE;
+    while (zr * zr + zi * zi < ESCAPE_RADIUS_SQ && n > 1)
+    {
+        double t = zr * zr - zi * zi + cr;
+        zi = 2.0 * zr * zi + ci;
+        zr = t;
+        n--;
+    }
+    return (uint8_t) n;
+}
+
+#ifdef __AVX2__
+// 8 pixels per call as two interleaved 4-lane vectors, which hides the latency
+// of the dependent multiply chain; lanes that escaped stay masked off
+static inline void julia_pixels_avx2(uint8_t* out, int j, double y, const JuliaParams* p)
+{
+    const __m256d radius = _mm256_set1_pd(ESCAPE_RADIUS_SQ);
+    const __m256d cr = _mm256_set1_pd(p->cr), ci = _mm256_set1_pd(p->ci);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d lane = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+
+    // x = x0 + j * dx per lane, rounded exactly like the scalar path
+    const __m256d x0 = _mm256_set1_pd(p->x0), dx = _mm256_set1_pd(p->dx);
+    __m256d zr0 = _mm256_add_pd(x0, _mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd((double) j), lane), dx));
+    __m256d zr1 = _mm256_add_pd(x0, _mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd((double) (j + 4)), lane), dx));
+    __m256d zi0 = _mm256_set1_pd(y), zi1 = _mm256_set1_pd(y);
+    __m256d n0 = _mm256_set1_pd(MAX_ESCAPE), n1 = n0;
+    __m256d active0 = _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), active1 = active0;
+
+    // n > 1 allows at most MAX_ESCAPE - 1 iterations
+    for (int it = 0; it < MAX_ESCAPE - 1; it++)
+    {
+        __m256d rr0 = _mm256_mul_pd(zr0, zr0), ii0 = _mm256_mul_pd(zi0, zi0);
+        __m256d rr1 = _mm256_mul_pd(zr1, zr1), ii1 = _mm256_mul_pd(zi1, zi1);
+
+        active0 = _mm256_and_pd(active0, _mm256_cmp_pd(_mm256_add_pd(rr0, ii0), radius, _CMP_LT_OQ));
+        active1 = _mm256_and_pd(active1, _mm256_cmp_pd(_mm256_add_pd(rr1, ii1), radius, _CMP_LT_OQ));
+        if (_mm256_movemask_pd(_mm256_or_pd(active0, active1)) == 0) break;
+
+        n0 = _mm256_sub_pd(n0, _mm256_and_pd(active0, one));
+        n1 = _mm256_sub_pd(n1, _mm256_and_pd(active1, one));
+
+        __m256d ri0 = _mm256_mul_pd(zr0, zi0), ri1 = _mm256_mul_pd(zr1, zi1);
+        zr0 = _mm256_add_pd(_mm256_sub_pd(rr0, ii0), cr);
+        zr1 = _mm256_add_pd(_mm256_sub_pd(rr1, ii1), cr);
+        zi0 = _mm256_add_pd(_mm256_add_pd(ri0, ri0), ci);
+        zi1 = _mm256_add_pd(_mm256_add_pd(ri1, ri1), ci);
+    }
+
+    int32_t counts[8];
+    _mm_storeu_si128((__m128i*) &counts[0], _mm256_cvtpd_epi32(n0));
+    _mm_storeu_si128((__m128i*) &counts[4], _mm256_cvtpd_epi32(n1));
+    for (int k = 0; k < 8; k++)
+        out[k] = (uint8_t) counts[k];
+}
+#endif
+
+// one image row k (top row is y1), vector kernel where available
+static inline void julia_row(uint8_t* out, int k, int j0, int j1, const JuliaParams* p)
+{
+    double y = p->y1 - k * p->dy;
+    int j = j0;
+#ifdef __AVX2__
+    for (; j + 8 <= j1; j += 8)
+        julia_pixels_avx2(&out[j - j0], j, y, p);
+#endif
+    for (; j < j1; j++)
+        out[j - j0] = julia_pixel(p->x0 + j * p->dx, y, p->cr, p->ci);
+}
+
+static inline int write_pgm_header(FILE* f, int w, int h)
+{
+    return fprintf(f, "P5 %d %d 255\n", w, h);
+}
+
+#endif
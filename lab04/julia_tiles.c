@@ -0,0 +1,268 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "julia.h"
+
+#define DEFAULT_TILE_W 1024
+#define DEFAULT_TILE_H 64
+
+// pixel rectangle [px0, px1) x [py0, py1) covered by tiles
+typedef struct {
+    int px0, py0, px1, py1;
+    int tile_w, tile_h;
+    int cols, rows;
+} TileGrid;
+
+static void tile_grid_init(TileGrid* grid, int px0, int py0, int px1, int py1, int tile_w, int tile_h)
+{
+    grid->px0 = px0; grid->py0 = py0;
+    grid->px1 = px1; grid->py1 = py1;
+    grid->tile_w = tile_w;
+    grid->tile_h = tile_h;
+    grid->cols = (px1 - px0 + tile_w - 1) / tile_w;
+    grid->rows = (py1 - py0 + tile_h - 1) / tile_h;
+}
+
+// bounds of tile t, clipped to the grid rectangle
+static void tile_bounds(const TileGrid* grid, long long t, int* j0, int* k0, int* j1, int* k1)
+{
+    int row = (int)(t / grid->cols), col = (int)(t % grid->cols);
+    *j0 = grid->px0 + col * grid->tile_w;
+    *k0 = grid->py0 + row * grid->tile_h;
+    *j1 = *j0 + grid->tile_w < grid->px1 ? *j0 + grid->tile_w : grid->px1;
+    *k1 = *k0 + grid->tile_h < grid->py1 ? *k0 + grid->tile_h : grid->py1;
+}
+
+// shared tile counter on rank 0, claimed with MPI_Fetch_and_op so no rank has
+// to act as a dispatcher
+static long long claim_tile(MPI_Win counter)
+{
+    const long long one = 1;
+    long long tile;
+    MPI_Fetch_and_op(&one, &tile, MPI_LONG_LONG, 0, 0, MPI_SUM, counter);
+    MPI_Win_flush(0, counter);
+    return tile;
+}
+
+// render one tile and write it with a single call: the file view of this
+// rank's own handle (opened on MPI_COMM_SELF) is set to the tile's rows, so the
+// strided placement is left to MPI-IO instead of one write per row
+static void render_tile(MPI_File fh, MPI_Offset header, int image_w, uint8_t* buf, const JuliaParams* p,
+                        int j0, int k0, int j1, int k1)
+{
+    const int span = j1 - j0, rows = k1 - k0;
+    for (int k = k0; k < k1; k++)
+        julia_row(&buf[(size_t)(k - k0) * span], k, j0, j1, p);
+
+    MPI_Datatype tile_type;
+    MPI_Type_vector(rows, span, image_w, MPI_BYTE, &tile_type);
+    MPI_Type_commit(&tile_type);
+    MPI_File_set_view(fh, header + (MPI_Offset) k0 * image_w + j0, MPI_BYTE, tile_type, "native", MPI_INFO_NULL);
+    MPI_File_write_at(fh, 0, buf, rows * span, MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_Type_free(&tile_type);
+}
+
+// rank 0 reads "P5 <w> <h> <maxval>" and the single whitespace after it; the
+// result (0 on a malformed header) is broadcast to every rank
+static int read_pgm_header(MPI_File fh, int rank, int* w, int* h, MPI_Offset* header_len)
+{
+    long long info[3] = {0, 0, 0};
+    if (rank == 0)
+    {
+        char text[128] = {0};
+        MPI_File_read_at(fh, 0, text, (int) sizeof(text) - 1, MPI_BYTE, MPI_STATUS_IGNORE);
+
+        char magic[3];
+        int fw, fh_, maxval, used = 0;
+        if (sscanf(text, "%2s %d %d %d%n", magic, &fw, &fh_, &maxval, &used) == 4
+            && strcmp(magic, "P5") == 0 && maxval == 255 && used < (int) sizeof(text) - 1)
+        {
+            info[0] = fw;
+            info[1] = fh_;
+            info[2] = used + 1;
+        }
+    }
+    MPI_Bcast(info, 3, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    *w = (int) info[0];
+    *h = (int) info[1];
+    *header_len = (MPI_Offset) info[2];
+    return info[2] > 0;
+}
+
+// usage: julia_tiles <w> <h> [file] [tile_w tile_h] [px0 py0 px1 py1 [x0 x1 y0 y1 [cr ci]]]
+// with a pixel window only tiles inside it are rendered, into an existing w x h
+// file, leaving the rest of the image untouched. Without a view the window is
+// recomputed as it was (repairing damaged or unfinished tiles); with one, the
+// complex rectangle [x0, x1] x [y0, y1] (and constant cr + ci i) is drawn into
+// the window, e.g. a zoomed inset
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc < 3)
+    {
+        if (rank == 0)
+            fprintf(stderr, "Usage: %s <w> <h> [file] [tile_w tile_h] [px0 py0 px1 py1 [x0 x1 y0 y1 [cr ci]]]\n", argv[0]);
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    JuliaParams p = julia_default_params();
+    julia_set_size(&p, atoi(argv[1]), atoi(argv[2]));
+    const char* filename = argc > 3 ? argv[3] : "julia_tiles.pgm";
+    int tile_w = argc > 5 ? atoi(argv[4]) : DEFAULT_TILE_W;
+    int tile_h = argc > 5 ? atoi(argv[5]) : DEFAULT_TILE_H;
+    if (p.w <= 0 || p.h <= 0 || tile_w <= 0 || tile_h <= 0)
+    {
+        if (rank == 0) fprintf(stderr, "Error: image and tile sizes must be positive\n");
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    int partial = argc > 9;
+    int px0 = 0, py0 = 0, px1 = p.w, py1 = p.h;
+    if (partial)
+    {
+        px0 = atoi(argv[6]); py0 = atoi(argv[7]);
+        px1 = atoi(argv[8]); py1 = atoi(argv[9]);
+        if (px0 < 0) px0 = 0;
+        if (py0 < 0) py0 = 0;
+        if (px1 > p.w) px1 = p.w;
+        if (py1 > p.h) py1 = p.h;
+    }
+
+    // view of the pixels being rendered, expressed for whole-image coordinates
+    // j, k so julia_row needs no window offsets; by default the image's own view
+    JuliaParams view = p;
+    if (argc > 13 && px1 > px0 && py1 > py0)
+    {
+        double x0 = atof(argv[10]), x1 = atof(argv[11]);
+        double y0 = atof(argv[12]), y1 = atof(argv[13]);
+        view.dx = (x1 - x0) / (px1 - px0);
+        view.dy = (y1 - y0) / (py1 - py0);
+        view.x0 = x0 - px0 * view.dx;
+        view.x1 = view.x0 + p.w * view.dx;
+        view.y1 = y1 + py0 * view.dy;
+        view.y0 = view.y1 - p.h * view.dy;
+        if (argc > 15)
+        {
+            view.cr = atof(argv[14]);
+            view.ci = atof(argv[15]);
+        }
+    }
+
+    TileGrid grid;
+    tile_grid_init(&grid, px0, py0, px1, py1, tile_w, tile_h);
+    long long tiles = px1 > px0 && py1 > py0 ? (long long) grid.cols * grid.rows : 0;
+
+    char header[64];
+    MPI_Offset header_len = snprintf(header, sizeof(header), "P5 %d %d 255\n", p.w, p.h);
+
+    // a partial render patches an existing image of the same size, a full one
+    // creates it
+    MPI_File fh;
+    int mode = partial ? MPI_MODE_RDWR : MPI_MODE_WRONLY | MPI_MODE_CREATE;
+    if (MPI_File_open(MPI_COMM_WORLD, filename, mode, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+        if (rank == 0) fprintf(stderr, "Error opening %s\n", filename);
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    if (partial)
+    {
+        int file_w, file_h;
+        MPI_Offset size;
+        MPI_File_get_size(fh, &size);
+        if (!read_pgm_header(fh, rank, &file_w, &file_h, &header_len)
+            || file_w != p.w || file_h != p.h || size < header_len + (MPI_Offset) p.w * p.h)
+        {
+            if (rank == 0)
+                fprintf(stderr, "Error: %s is not a %dx%d binary PGM (found %dx%d)\n",
+                        filename, p.w, p.h, file_w, file_h);
+            MPI_File_close(&fh);
+            MPI_Finalize();
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        MPI_File_set_size(fh, header_len + (MPI_Offset) p.w * p.h);
+        if (rank == 0)
+            MPI_File_write_at(fh, 0, header, (int) header_len, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    MPI_File_close(&fh);
+
+    // tiles go through a private handle, so each rank can move its file view
+    // per tile without a collective call
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MPI_File_open(MPI_COMM_SELF, filename, MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Error opening %s on rank %d\n", filename, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    long long* counter_base;
+    MPI_Win counter;
+    MPI_Win_allocate(rank == 0 ? sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &counter_base, &counter);
+    if (rank == 0)
+    {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, counter);
+        *counter_base = 0;
+        MPI_Win_unlock(0, counter);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t_start = MPI_Wtime();
+
+    // one tile buffer per rank, independent of image size
+    uint8_t* buf = (uint8_t*) malloc((size_t) tile_w * tile_h);
+    long long my_tiles = 0;
+    double my_time = 0.0;
+
+    MPI_Win_lock_all(0, counter);
+    for (long long t = claim_tile(counter); t < tiles; t = claim_tile(counter))
+    {
+        int j0, k0, j1, k1;
+        tile_bounds(&grid, t, &j0, &k0, &j1, &k1);
+
+        double t_tile = MPI_Wtime();
+        render_tile(fh, header_len, p.w, buf, &view, j0, k0, j1, k1);
+        my_time += MPI_Wtime() - t_tile;
+        my_tiles++;
+    }
+    MPI_Win_unlock_all(counter);
+
+    MPI_File_close(&fh);
+    double elapsed = MPI_Wtime() - t_start;
+
+    long long min_tiles, max_tiles;
+    double min_time, max_time, max_elapsed;
+    MPI_Reduce(&my_tiles, &min_tiles, 1, MPI_LONG_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&my_tiles, &max_tiles, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&my_time, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&my_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        double pixels = (double)(px1 - px0) * (py1 - py0);
+        printf("%s %dx%d, window [%d,%d)x[%d,%d), %lld tiles of %dx%d\n",
+               partial ? "Re-rendered" : "Rendered", p.w, p.h, px0, px1, py0, py1, tiles, tile_w, tile_h);
+        printf("Tiles per rank: min %lld, max %lld\n", min_tiles, max_tiles);
+        printf("Busy time per rank: min %.6f s, max %.6f s\n", min_time, max_time);
+        printf("Execution Time: %f seconds (%.2f Mpix/s)\n", max_elapsed, pixels / max_elapsed / 1e6);
+    }
+
+    free(buf);
+    MPI_Win_free(&counter);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <mpi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph.h"
+#include "tour.h"
+#include "candidates.h"
+#include "local_search.h"
+
+#define DEFAULT_CITIES 5000
+#define DEFAULT_TIME_LIMIT 10.0
+#define CANDIDATE_K 10
+
+// uniform random cities in a square, same instance on every run
+void build_random_graph(Graph* g, int n, float side)
+{
+    graph_alloc(g, n);
+    srand(42);
+    for (int i = 0; i < n; i++)
+    {
+        g->x[i] = side * (float) rand() / (float) RAND_MAX;
+        g->y[i] = side * (float) rand() / (float) RAND_MAX;
+    }
+}
+
+// wall clock for the calling thread: MPI_Wtime is off limits to the workers
+// under MPI_THREAD_FUNNELED
+static double thread_wtime(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return MPI_Wtime();
+#endif
+}
+
+// iterated local search from one randomised start: kick with a double bridge,
+// repair locally, keep the result only if it is shorter; stops time_budget
+// seconds after it was called
+float iterated_local_search(const Graph* g, const Candidates* cand, uint64_t seed,
+                            double time_budget, int* best_order, long* iterations)
+{
+    const double deadline = thread_wtime() + time_budget;
+    Search s;
+    search_init(&s, g, cand);
+    int* scratch = (int*) malloc((size_t) g->n * sizeof(int));
+    uint64_t rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+
+    nearest_neighbour_candidates(g, cand, rng_int(&rng, g->n), best_order);
+    tour_from_array(&s.t, best_order, g->n);
+    for (int i = 0; i < g->n; i++) search_push(&s, best_order[i]);
+    double best = local_search(&s, tour_length(g, &s.t));
+    tour_to_array(&s.t, best_order);
+
+    long it = 0;
+    while (thread_wtime() < deadline)
+    {
+        double cost = double_bridge(&s, best, &rng, scratch);
+        cost = local_search(&s, cost);
+        it++;
+
+        if (cost < best - LS_EPS)
+        {
+            best = cost;
+            tour_to_array(&s.t, best_order);
+        }
+        else
+            tour_from_array(&s.t, best_order, g->n);
+    }
+
+    *iterations = it;
+    search_free(&s);
+    free(scratch);
+
+    // incremental gains drift in float, report the exact length
+    return tour_cost(g, best_order);
+}
+
+// usage: approx [graph_file | city_count] [time_limit_seconds]
+// every rank runs one independent iterated local search per OpenMP thread,
+// the shortest tour over all ranks and threads wins
+int main(int argc, char** argv)
+{
+    const int s = 0; // set to 1 to save graph x, y and tour into file
+
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    double time_limit = DEFAULT_TIME_LIMIT;
+    if (argc > 2) time_limit = atof(argv[2]);
+
+    Graph g = {0};
+    int loaded = 1;
+    if (rank == 0)
+    {
+        char* end = NULL;
+        long cities = argc > 1 ? strtol(argv[1], &end, 10) : DEFAULT_CITIES;
+
+        // a plain number asks for a random instance of that size
+        if (argc > 1 && (*end != '\0' || cities < 2)) loaded = load_graph(argv[1], &g);
+        else build_random_graph(&g, (int) cities, 10000.0f);
+    }
+
+    MPI_Bcast(&loaded, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!loaded)
+    {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    broadcast_graph(&g, 0, MPI_COMM_WORLD);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+
+    Candidates cand;
+    candidates_build(&cand, &g, CANDIDATE_K);
+
+    // every thread keeps its own tour, the rank keeps the best of them
+    int* rank_best = (int*) malloc((size_t) g.n * sizeof(int));
+    float rank_best_cost = -1.0f;
+    long total_iterations = 0;
+    // what is left of the limit after setup, spent by every thread on its own clock
+    double time_budget = start_time + time_limit - MPI_Wtime();
+
+    #pragma omp parallel reduction(+:total_iterations)
+    {
+        int tid = 0, threads = 1;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+        threads = omp_get_num_threads();
+#endif
+        int* order = (int*) malloc((size_t) g.n * sizeof(int));
+        long it = 0;
+        float cost = iterated_local_search(&g, &cand, (uint64_t) rank * threads + tid + 1,
+                                           time_budget, order, &it);
+        total_iterations += it;
+
+        #pragma omp critical
+        {
+            if (rank_best_cost < 0.0f || cost < rank_best_cost)
+            {
+                rank_best_cost = cost;
+                memcpy(rank_best, order, (size_t) g.n * sizeof(int));
+            }
+        }
+        free(order);
+    }
+
+    // find the owner of the global best and broadcast its tour
+    struct { float cost; int rank; } local = { rank_best_cost, rank }, global;
+    MPI_Allreduce(&local, &global, 1, MPI_FLOAT_INT, MPI_MINLOC, MPI_COMM_WORLD);
+    MPI_Bcast(rank_best, g.n, MPI_INT, global.rank, MPI_COMM_WORLD);
+
+    long all_iterations = 0;
+    MPI_Reduce(&total_iterations, &all_iterations, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    double end_time = MPI_Wtime();
+
+    if (rank == 0)
+    {
+        tour_rotate_to_zero(rank_best, g.n);
+        printf("Cities: %d, kicks: %ld\n", g.n, all_iterations);
+        printf("Tour Cost: %.4f\n", global.cost);
+        printf("Execution Time: %f seconds\n", end_time - start_time);
+
+        if (s)
+        {
+            save_coords("data/coords.txt", &g);
+            save_solution("data/solution.txt", rank_best, g.n, global.cost);
+        }
+    }
+
+    free(rank_best);
+    candidates_free(&cand);
+    graph_free(&g);
+    MPI_Finalize();
+    return 0;
+}
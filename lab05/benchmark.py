@@ -1,52 +1,82 @@
+import json
 import os
-import time
 import subprocess
+import tempfile
 import numpy as np
 import matplotlib.pyplot as plt
 
-def time_once(cmd):
-    t0 = time.perf_counter()
+# every rank runs THREADS_PER_RANK OpenMP threads; left to itself each rank
+# would start one thread per core and the process sweep would oversubscribe
+THREADS_PER_RANK = 1
+
+# salesman reports its own per-phase times (common/metrics.h), so launcher
+# startup is not part of the numbers; the slowest rank defines each phase's time
+def run_once(cmd):
     print("benchmarking ", cmd)
-    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
-    return time.perf_counter() - t0
+    with tempfile.NamedTemporaryFile(suffix=".jsonl", delete=False) as f:
+        metrics_file = f.name
+    try:
+        env = dict(os.environ, METRICS_FILE=metrics_file, OMP_NUM_THREADS=str(THREADS_PER_RANK))
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, env=env)
+        with open(metrics_file) as f:
+            record = json.loads(f.readlines()[-1])
+    finally:
+        os.remove(metrics_file)
+
+    times = {"total": record["total"]["max"]}
+    times.update({name: stat["max"] for name, stat in record["phases"].items()})
+    return times
 
+# Open MPI binds each rank to one core by default, which would pack all of a
+# rank's threads onto it; with one thread per rank the binding is kept, with
+# more each rank gets THREADS_PER_RANK cores (pe=) of its own
 def build_cmd(process_count, prefix_count):
-    return ["mpiexec", "-n", str(process_count), "./salesman", str(prefix_count)]
+    binding = ["--map-by", f"slot:pe={THREADS_PER_RANK}"] if THREADS_PER_RANK > 1 else []
+    return ["mpiexec", "-n", str(process_count), *binding, "./salesman", str(prefix_count)]
 
 def bench_grid(prefix_count, thread_counts, repeats):
-    means = []
-    stds = []
+    means = {}
+    stds = {}
     for p in thread_counts:
-        runs = [time_once(build_cmd(p, prefix_count)) for _ in range(repeats)]
-        means.append(np.mean(runs))
-        stds.append(np.std(runs))
-    return np.array(means), np.array(stds)
+        runs = [run_once(build_cmd(p, prefix_count)) for _ in range(repeats)]
+        for phase in runs[0]:
+            means.setdefault(phase, []).append(np.mean([r[phase] for r in runs]))
+            stds.setdefault(phase, []).append(np.std([r[phase] for r in runs]))
+    return ({k: np.array(v) for k, v in means.items()},
+            {k: np.array(v) for k, v in stds.items()})
+
+def speedup_metrics(means, stds, thread_counts):
+    t1 = means[0]
+    speedup = np.divide(t1, means, out=np.zeros_like(means), where=means > 0)
+    efficiency = speedup / thread_counts
+
+    sf = []
+    sf_threads = []
+    for s, p in zip(speedup, thread_counts):
+        if p > 1 and s > 0:
+            e = ((1/s) - (1/p)) / (1 - (1/p))
+            sf.append(e)
+            sf_threads.append(p)
 
+    return {
+        "mean": means,
+        "std": stds,
+        "speedup": speedup,
+        "efficiency": efficiency,
+        "serial_fraction": np.array(sf),
+        "sf_threads": np.array(sf_threads)
+    }
+
+# results[N] describes the in-process total, phases[N][phase] each timed phase
 def compute_metrics(runtimes, thread_counts):
     results = {}
+    phases = {}
     for N, (means, stds) in runtimes.items():
-        t1 = means[0]
-        speedup = t1 / means
-        efficiency = speedup / thread_counts
-        
-        sf = []
-        sf_threads = []
-        for s, p in zip(speedup, thread_counts):
-            if p > 1:
-                e = ((1/s) - (1/p)) / (1 - (1/p))
-                sf.append(e)
-                sf_threads.append(p)
-        
-        results[N] = {
-            "mean": means,
-            "std": stds,
-            "speedup": speedup,
-            "efficiency": efficiency,
-            "serial_fraction": np.array(sf),
-            "sf_threads": np.array(sf_threads)
-        }
+        results[N] = speedup_metrics(means["total"], stds["total"], thread_counts)
+        phases[N] = {phase: speedup_metrics(means[phase], stds[phase], thread_counts)
+                     for phase in means if phase != "total"}
 
-    return results
+    return results, phases
 
 def plot_all(results, thread_counts, out_dir):
     os.makedirs(out_dir, exist_ok=True)
@@ -84,14 +114,37 @@ def plot_all(results, thread_counts, out_dir):
         plt.savefig(os.path.join(out_dir, fname), dpi=200)
         plt.close()
 
+def plot_phases(phases, thread_counts, out_dir):
+    os.makedirs(out_dir, exist_ok=True)
+
+    for N, by_phase in sorted(phases.items()):
+        fig, (ax_s, ax_k) = plt.subplots(1, 2, figsize=(14, 5))
+        for phase, data in by_phase.items():
+            ax_s.plot(thread_counts, data["speedup"], marker="o", label=phase)
+            ax_k.plot(data["sf_threads"], data["serial_fraction"], marker="o", label=phase)
+
+        ax_s.set_title(f"Per-phase Speedup (Depth={N})")
+        ax_s.set_ylabel("Speedup (T1/Tp)")
+        ax_k.set_title(f"Per-phase Serial Fraction (Depth={N})")
+        ax_k.set_ylabel("Serial Fraction")
+        for ax in (ax_s, ax_k):
+            ax.set_xlabel("Process count")
+            ax.legend()
+            ax.grid(True, alpha=0.3)
+
+        plt.tight_layout()
+        plt.savefig(os.path.join(out_dir, f"phases_depth_{N}.png"), dpi=200)
+        plt.close()
+
 def main():
     PREFIX_COUNTS = [2, 3, 4]
     THREAD_COUNTS = np.arange(1, 11)
     REPEATS = 10
     
     runtimes = {N: bench_grid(N, THREAD_COUNTS, REPEATS) for N in PREFIX_COUNTS}
-    metrics = compute_metrics(runtimes, THREAD_COUNTS)
+    metrics, phases = compute_metrics(runtimes, THREAD_COUNTS)
     plot_all(metrics, THREAD_COUNTS, "data/benchmarks")
+    plot_phases(phases, THREAD_COUNTS, "data/benchmarks")
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+#include "graph.h"
+
+// uniform grid over the bounding box, roughly CELL_OCCUPANCY cities per cell
+#define CELL_OCCUPANCY 2
+
+typedef struct {
+    int cols, rows;
+    float min_x, min_y;
+    float cell;
+    int* start;  // cols*rows+1 offsets into items (CSR layout)
+    int* items;  // city ids bucketed by cell
+} Grid;
+
+typedef struct {
+    int k;
+    int* nbr; // n x k, nearest first
+} Candidates;
+
+static inline int grid_clamp(int v, int hi)
+{
+    return v < 0 ? 0 : (v > hi ? hi : v);
+}
+
+static inline int grid_col(const Grid* gr, float x)
+{
+    return grid_clamp((int)((x - gr->min_x) / gr->cell), gr->cols - 1);
+}
+
+static inline int grid_row(const Grid* gr, float y)
+{
+    return grid_clamp((int)((y - gr->min_y) / gr->cell), gr->rows - 1);
+}
+
+void grid_build(Grid* gr, const Graph* g)
+{
+    float max_x = g->x[0], max_y = g->y[0];
+    gr->min_x = g->x[0];
+    gr->min_y = g->y[0];
+    for (int i = 1; i < g->n; i++)
+    {
+        if (g->x[i] < gr->min_x) gr->min_x = g->x[i];
+        if (g->y[i] < gr->min_y) gr->min_y = g->y[i];
+        if (g->x[i] > max_x) max_x = g->x[i];
+        if (g->y[i] > max_y) max_y = g->y[i];
+    }
+
+    float w = max_x - gr->min_x, h = max_y - gr->min_y;
+    float area = (w > 0 ? w : 1.0f) * (h > 0 ? h : 1.0f);
+    gr->cell = sqrtf(area * CELL_OCCUPANCY / g->n);
+    if (gr->cell <= 0) gr->cell = 1.0f;
+    gr->cols = (int)(w / gr->cell) + 1;
+    gr->rows = (int)(h / gr->cell) + 1;
+
+    size_t cells = (size_t) gr->cols * gr->rows;
+    gr->start = (int*) calloc(cells + 1, sizeof(int));
+    gr->items = (int*) malloc((size_t) g->n * sizeof(int));
+
+    // counting sort of cities into cells
+    for (int i = 0; i < g->n; i++)
+        gr->start[(size_t) grid_row(gr, g->y[i]) * gr->cols + grid_col(gr, g->x[i]) + 1]++;
+    for (size_t c = 0; c < cells; c++)
+        gr->start[c + 1] += gr->start[c];
+
+    int* fill = (int*) malloc(cells * sizeof(int));
+    memcpy(fill, gr->start, cells * sizeof(int));
+    for (int i = 0; i < g->n; i++)
+        gr->items[fill[(size_t) grid_row(gr, g->y[i]) * gr->cols + grid_col(gr, g->x[i])]++] = i;
+    free(fill);
+}
+
+void grid_free(Grid* gr)
+{
+    free(gr->start);
+    free(gr->items);
+}
+
+// keep the k closest seen so far in best[]/best_d[], sorted ascending
+static void candidate_insert(int* best, float* best_d, int* found, int k, int city, float d)
+{
+    if (*found == k && d >= best_d[k - 1]) return;
+
+    int pos = *found < k ? (*found)++ : k - 1;
+    while (pos > 0 && best_d[pos - 1] > d)
+    {
+        best[pos] = best[pos - 1];
+        best_d[pos] = best_d[pos - 1];
+        pos--;
+    }
+    best[pos] = city;
+    best_d[pos] = d;
+}
+
+// k nearest neighbours of every city, searching grid rings outwards until the
+// next ring cannot contain anything closer than the current k-th candidate
+void candidates_build(Candidates* cand, const Graph* g, int k)
+{
+    if (k > g->n - 1) k = g->n - 1;
+    cand->k = k;
+    cand->nbr = (int*) malloc((size_t) g->n * k * sizeof(int));
+
+    Grid gr;
+    grid_build(&gr, g);
+    float* best_d = (float*) malloc((size_t) k * sizeof(float));
+
+    for (int i = 0; i < g->n; i++)
+    {
+        int* best = &cand->nbr[(size_t) i * k];
+        int found = 0;
+        int ci = grid_col(&gr, g->x[i]), ri = grid_row(&gr, g->y[i]);
+        int max_ring = gr.cols > gr.rows ? gr.cols : gr.rows;
+
+        for (int ring = 0; ring <= max_ring; ring++)
+        {
+            // every city outside rings 0..ring-1 is at least (ring-1)*cell away
+            if (found == k && best_d[k - 1] < (ring - 1) * gr.cell) break;
+
+            for (int r = ri - ring; r <= ri + ring; r++)
+            {
+                if (r < 0 || r >= gr.rows) continue;
+                int edge_row = (r == ri - ring || r == ri + ring);
+                int step = edge_row ? 1 : 2 * ring;
+
+                for (int c = ci - ring; c <= ci + ring; c += (step ? step : 1))
+                {
+                    if (c < 0 || c >= gr.cols) continue;
+                    size_t cell = (size_t) r * gr.cols + c;
+                    for (int p = gr.start[cell]; p < gr.start[cell + 1]; p++)
+                    {
+                        int j = gr.items[p];
+                        if (j != i)
+                            candidate_insert(best, best_d, &found, k, j, graph_dist(g, i, j));
+                    }
+                }
+            }
+        }
+    }
+
+    free(best_d);
+    grid_free(&gr);
+}
+
+void candidates_free(Candidates* cand)
+{
+    free(cand->nbr);
+    cand->nbr = NULL;
+}
+
+#endif
@@ -1,274 +1,551 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <float.h>
 #include <string.h>
 #include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-#define MAX_NODES 20
+#include "graph.h"
+#include "tour.h"
+#include "../common/metrics.h"
+#include "../common/perf_counters.h"
+#include "trace.h"
 
 #define TAG_TASK 1
 #define TAG_RESULT 2
 #define TAG_KILL 3
+#define TAG_DONE 4
 
-typedef struct {
-    int n;
-    float x[MAX_NODES];
-    float y[MAX_NODES];
-    float dist[MAX_NODES][MAX_NODES]; 
-} Graph;
+#define BATCH_FACTOR 4      // guided batches: remaining / (BATCH_FACTOR * workers)
+#define MAX_BATCH 256
+#define PREFETCH_PER_THREAD 2  // worker asks for more once its deque is this shallow
+
+// phases reported by salesman through common/metrics.h, heuristic and expand
+// only run on the master
+enum { PHASE_SETUP, PHASE_HEURISTIC, PHASE_EXPAND, PHASE_SEARCH, PHASE_COUNT };
+static const char* phase_names[PHASE_COUNT] = { "setup", "heuristic", "expand", "search" };
 
+// path holds g->n entries, use task_size / task_at to address tasks
 typedef struct {
-    int path[MAX_NODES]; 
-    int count;       
+    int count;
     float current_cost;
     float lower_bound;
+    float upper_bound;  // incumbent known to master when task was dispatched
+    int path[];
 } Task;
 
 typedef struct {
     float cost;
-    int path[MAX_NODES];
+    int path[];
 } SearchResult;
 
-float calc_dist(float x1, float y1, float x2, float y2) 
+static inline size_t task_size(int n)
 {
-    return sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2));
+    return sizeof(Task) + (size_t) n * sizeof(int);
 }
 
-float compute_bound(Graph *g, Task *t) 
+static inline Task* task_at(void* base, size_t i, int n)
 {
-    if (t->count == g->n) return t->current_cost;
-    return t->current_cost;
+    return (Task*)((char*) base + i * task_size(n));
 }
 
-void save_coords(const char* filename, Graph* g) 
+static inline size_t result_size(int n)
 {
-    FILE* f = fopen(filename, "w");
-    if (f == NULL) {
-        perror("Error opening coordinates file");
-        return;
-    }
+    return sizeof(SearchResult) + (size_t) n * sizeof(int);
+}
+
+// lower bound on any tour extending path[0..count-1]: the last city and every
+// unvisited city still have to be left once, at no less than their cheapest edge
+float compute_bound(const Graph *g, const int *path, int count, float current_cost)
+{
+    if (count == g->n) return current_cost + DIST(g, path[count - 1], path[0]);
 
-    fprintf(f, "ID\tX\tY\n");
+    float bound = current_cost;
     for (int i = 0; i < g->n; i++)
-        fprintf(f, "%d\t%.4f\t%.4f\n", i, g->x[i], g->y[i]);
-    
+        bound += g->min_edge[i];
+    for (int k = 0; k < count - 1; k++)
+        bound -= g->min_edge[path[k]];
+    return bound;
+}
 
-    fclose(f);
-    printf("Coordinates saved to %s\n", filename);
+void create_task_type(MPI_Datatype *dt, int n)
+{
+    int blocks[5] = {1, 1, 1, 1, n};
+    MPI_Aint disps[5] = {
+        offsetof(Task, count),
+        offsetof(Task, current_cost),
+        offsetof(Task, lower_bound),
+        offsetof(Task, upper_bound),
+        offsetof(Task, path)
+    };
+    MPI_Datatype types[5] = {MPI_INT, MPI_FLOAT, MPI_FLOAT, MPI_FLOAT, MPI_INT};
+    MPI_Datatype tmp;
+
+    MPI_Type_create_struct(5, blocks, disps, types, &tmp);
+    MPI_Type_create_resized(tmp, 0, (MPI_Aint) task_size(n), dt);
+    MPI_Type_commit(dt);
+    MPI_Type_free(&tmp);
 }
 
-void save_solution(const char* filename, int* path, int n, float cost) 
+void create_result_type(MPI_Datatype *dt, int n) {
+    int blocks[2] = {1, n};
+    MPI_Aint disps[2] = {offsetof(SearchResult, cost), offsetof(SearchResult, path)};
+    MPI_Datatype types[2] = {MPI_FLOAT, MPI_INT};
+    MPI_Datatype tmp;
+
+    MPI_Type_create_struct(2, blocks, disps, types, &tmp);
+    MPI_Type_create_resized(tmp, 0, (MPI_Aint) result_size(n), dt);
+    MPI_Type_commit(dt);
+    MPI_Type_free(&tmp);
+}
+
+// depth-first search below path[0..count-1], one shared path buffer instead of per-level copies
+static void branch(const Graph *g, int *path, int count, char *visited, float current_cost,
+                   float *local_best_cost, int *local_best_path)
 {
-    FILE* f = fopen(filename, "w");
-    if (f == NULL) {
-        perror("Error opening solution file");
+    if (count == g->n)
+    {
+        float total = current_cost + DIST(g, path[count-1], path[0]);
+        if (total < *local_best_cost)
+        {
+            *local_best_cost = total;
+            memcpy(local_best_path, path, sizeof(int) * g->n);
+        }
         return;
     }
 
-    fprintf(f, "Optimal Cost: %.4f\n", cost);
+    int last_node = path[count - 1];
 
-    for (int i = 0; i < n; i++)
-        fprintf(f, "%d ", path[i]);
-    
-    fprintf(f, "%d\n", path[0]);
+    for (int i = 0; i < g->n; i++)
+    {
+        if (visited[i]) continue;
+
+        path[count] = i;
+        float next_cost = current_cost + DIST(g, last_node, i);
+        if (compute_bound(g, path, count + 1, next_cost) >= *local_best_cost) continue;
 
-    fclose(f);
-    printf("Solution saved to %s\n", filename);
+        visited[i] = 1;
+        branch(g, path, count + 1, visited, next_cost, local_best_cost, local_best_path);
+        visited[i] = 0;
+    }
 }
 
-void create_task_type(MPI_Datatype *dt) 
-{
-    int blocks[4] = {MAX_NODES, 1, 1, 1};
-    MPI_Aint disps[4];
-    MPI_Datatype types[4] = {MPI_INT, MPI_INT, MPI_FLOAT, MPI_FLOAT};
-    Task dummy;
+// solve for subtree
+void solve_subtree_recursive(Graph *g, const Task *t, float *local_best_cost, int *local_best_path) {
+    if (t->lower_bound >= *local_best_cost) return;
 
-    MPI_Get_address(&dummy.path, &disps[0]);
-    MPI_Get_address(&dummy.count, &disps[1]);
-    MPI_Get_address(&dummy.current_cost, &disps[2]);
-    MPI_Get_address(&dummy.lower_bound, &disps[3]);
+    int *path = (int*) malloc(sizeof(int) * g->n);
+    char *visited = (char*) calloc(g->n, 1);
+    memcpy(path, t->path, sizeof(int) * t->count);
+    for (int k = 0; k < t->count; k++) visited[t->path[k]] = 1;
 
-    for(int i=3; i>=0; i--) 
-        disps[i] -= disps[0];
+    branch(g, path, t->count, visited, t->current_cost, local_best_cost, local_best_path);
 
-    MPI_Type_create_struct(4, blocks, disps, types, dt);
-    MPI_Type_commit(dt);
+    free(path);
+    free(visited);
 }
 
-void create_result_type(MPI_Datatype *dt) {
-    int blocks[2] = {1, MAX_NODES};
-    MPI_Aint disps[2];
-    MPI_Datatype types[2] = {MPI_FLOAT, MPI_INT};
-
-    SearchResult dummy;
-    MPI_Get_address(&dummy.cost, &disps[0]);
-    MPI_Get_address(&dummy.path, &disps[1]);
-    disps[1] -= disps[0];
-    disps[0] = 0;
+// tasks and incumbent shared by the threads of one rank
+typedef struct {
+    Graph *g;
+    void *tasks;            // deque of tasks, popped at head, batches appended at tail
+    size_t head, tail, capacity;
+    float bound;            // best cost known anywhere, used for pruning
+    SearchResult *best;     // best tour found on this rank
+    int request_pending;    // a work request to master is in flight
+    int no_more_work;       // master has nothing left to hand out
+    int watermark;
+    void *recv_buf;         // room for one incoming batch
+    MPI_Datatype task_type, result_type;
+    Trace *trace;
+} WorkerPool;
+
+static void pool_init(WorkerPool *pool, Graph *g, MPI_Datatype task_type, MPI_Datatype result_type, Trace *trace)
+{
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    memset(pool, 0, sizeof(WorkerPool));
+    pool->g = g;
+    pool->capacity = MAX_BATCH;
+    pool->tasks = malloc(pool->capacity * task_size(g->n));
+    pool->bound = FLT_MAX;
+    pool->best = (SearchResult*) calloc(1, result_size(g->n));
+    pool->best->cost = FLT_MAX;
+    pool->watermark = PREFETCH_PER_THREAD * threads;
+    pool->recv_buf = malloc(MAX_BATCH * task_size(g->n));
+    pool->task_type = task_type;
+    pool->result_type = result_type;
+    pool->trace = trace;
+}
 
-    MPI_Type_create_struct(2, blocks, disps, types, dt);
-    MPI_Type_commit(dt);
+static void pool_free(WorkerPool *pool)
+{
+    free(pool->tasks);
+    free(pool->best);
+    free(pool->recv_buf);
 }
 
-// solve for subtree
-void solve_subtree_recursive(Graph *g, Task t, float *local_best_cost, int *local_best_path) {
-    if (t.lower_bound >= *local_best_cost) return;
+// append count tasks; caller holds the deque critical section
+static void pool_push(WorkerPool *pool, void *tasks, size_t count)
+{
+    const int n = pool->g->n;
+    if (pool->head == pool->tail)
+        pool->head = pool->tail = 0;
+
+    if (pool->tail + count > pool->capacity)
+    {
+        while (pool->tail + count > pool->capacity) pool->capacity *= 2;
+        pool->tasks = realloc(pool->tasks, pool->capacity * task_size(n));
+    }
+
+    memcpy(task_at(pool->tasks, pool->tail, n), tasks, count * task_size(n));
+    pool->tail += count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float ub = task_at(tasks, i, n)->upper_bound;
+        if (ub < pool->bound) pool->bound = ub;
+    }
+}
 
-    if (t.count == g->n) 
+// copy the next task into t, returns 0 when the deque is empty
+static int pool_pop(WorkerPool *pool, Task *t)
+{
+    int got = 0;
+    #pragma omp critical(deque)
     {
-        float total = t.current_cost + g->dist[t.path[t.count-1]][t.path[0]];
-        if (total < *local_best_cost) 
+        if (pool->head < pool->tail)
         {
-            *local_best_cost = total;
-            memcpy(local_best_path, t.path, sizeof(int) * g->n);
+            memcpy(t, task_at(pool->tasks, pool->head++, pool->g->n), task_size(pool->g->n));
+            got = 1;
         }
-        return;
     }
+    return got;
+}
 
-    int last_node = t.path[t.count - 1];
-    
-    for (int i = 0; i < g->n; i++) 
+static size_t pool_depth(WorkerPool *pool)
+{
+    size_t depth;
+    #pragma omp critical(deque)
+    depth = pool->tail - pool->head;
+    return depth;
+}
+
+// called by any thread between tasks: ask master for the next batch once the deque
+// runs low, and take in the reply; blocks only for a thread that has nothing to do
+static void pool_communicate(WorkerPool *pool, int block)
+{
+    #pragma omp critical(comm)
     {
-        int visited = 0;
-        for(int k=0; k<t.count; k++) if(t.path[k] == i) visited = 1;
-        
-        if (!visited) 
+        if (!pool->no_more_work)
         {
-            Task next = t;
-            next.path[next.count] = i;
-            next.count++;
-            next.current_cost += g->dist[last_node][i];
-            next.lower_bound = compute_bound(g, &next);
-
-            if (next.lower_bound < *local_best_cost)
-                solve_subtree_recursive(g, next, local_best_cost, local_best_path);
+            size_t depth = pool_depth(pool);
+            if (!pool->request_pending && depth < (size_t) pool->watermark)
+            {
+                // the request doubles as a coalesced report of this rank's best tour
+                double t0 = trace_now(pool->trace);
+                #pragma omp critical(incumbent)
+                MPI_Send(pool->best, 1, pool->result_type, 0, TAG_RESULT, MPI_COMM_WORLD);
+                trace_event(pool->trace, TRACE_SEND, t0, 0, TAG_RESULT, 0, (long long) result_size(pool->g->n), (long long) depth);
+                pool->request_pending = 1;
+            }
+
+            int arrived = 0;
+            MPI_Status status;
+            if (pool->request_pending)
+            {
+                if (block)
+                {
+                    double t0 = trace_now(pool->trace);
+                    MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+                    arrived = 1;
+                    trace_event(pool->trace, TRACE_WAIT, t0, 0, status.MPI_TAG, 0, 0, -1);
+                }
+                else MPI_Iprobe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &arrived, &status);
+            }
+
+            if (arrived)
+            {
+                double t0 = trace_now(pool->trace);
+                int count = 0;
+                MPI_Get_count(&status, pool->task_type, &count);
+                MPI_Recv(pool->recv_buf, count, pool->task_type, 0, status.MPI_TAG, MPI_COMM_WORLD, &status);
+                pool->request_pending = 0;
+
+                if (status.MPI_TAG == TAG_KILL)
+                    pool->no_more_work = 1;
+                else
+                {
+                    #pragma omp critical(deque)
+                    #pragma omp critical(incumbent)
+                    {
+                        pool_push(pool, pool->recv_buf, (size_t) count);
+                        depth = pool->tail - pool->head;
+                    }
+                }
+                trace_event(pool->trace, TRACE_RECV, t0, 0, status.MPI_TAG, count,
+                            (long long) count * (long long) task_size(pool->g->n), (long long) depth);
+            }
         }
     }
 }
 
-// worker node
-void worker(int rank, Graph *g, MPI_Datatype task_type, MPI_Datatype result_type) 
-{
-    Task t;
-    MPI_Status status;
-    SearchResult res;
+// hardware counters of solve_subtree_recursive, summed over this rank's threads
+static PerfCounts search_perf;
 
-    while(1) 
+// every thread pops tasks from the shared deque, pruning against the rank-wide bound
+static void pool_run(WorkerPool *pool, int communicate)
+{
+    #pragma omp parallel
     {
-        MPI_Recv(&t, 1, task_type, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-        if (status.MPI_TAG == TAG_KILL) break;
+        const int n = pool->g->n;
+        Task *t = (Task*) malloc(task_size(n));
+        int *path = (int*) malloc(sizeof(int) * n);
+        PerfCounts local_perf = {0};
+        PerfRegion perf;
+        perf_region_open(&perf);
+
+        while (1)
+        {
+            if (communicate) pool_communicate(pool, 0);
 
-        res.cost = FLT_MAX;
-        solve_subtree_recursive(g, t, &res.cost, res.path);
+            if (pool_pop(pool, t))
+            {
+                float start, cost;
+                #pragma omp critical(incumbent)
+                start = pool->bound;
+
+                cost = start;
+                double t0 = trace_now(pool->trace);
+                perf_region_start(&perf);
+                solve_subtree_recursive(pool->g, t, &cost, path);
+                perf_region_stop(&perf, &local_perf);
+                trace_event(pool->trace, TRACE_TASK, t0, -1, 0, 1, 0, -1);
+
+                if (cost < start)
+                {
+                    #pragma omp critical(incumbent)
+                    {
+                        if (cost < pool->bound) pool->bound = cost;
+                        if (cost < pool->best->cost)
+                        {
+                            pool->best->cost = cost;
+                            memcpy(pool->best->path, path, sizeof(int) * n);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            int finished;
+            #pragma omp critical(comm)
+            finished = !communicate || pool->no_more_work;
+            if (finished && pool_depth(pool) == 0) break;
+
+            // nothing queued locally: wait for the next batch
+            if (communicate) pool_communicate(pool, 1);
+        }
 
-        MPI_Send(&res, 1, result_type, 0, TAG_RESULT, MPI_COMM_WORLD);
+        perf_region_close(&perf);
+        #pragma omp critical(perf)
+        perf_counts_merge(&search_perf, &local_perf);
+
+        free(t);
+        free(path);
     }
 }
 
-void master(int num_workers, Graph *g, MPI_Datatype task_type, MPI_Datatype result_type, int save, int initial_depth) 
+// worker node: one rank per node or socket, its threads share one deque
+void worker(Graph *g, MPI_Datatype task_type, MPI_Datatype result_type, Metrics *metrics,
+            Trace *trace) 
 {
-    Task *queue = (Task*) malloc(sizeof(Task) * 50000); 
-    int q_head = 0;
-    int q_tail = 0;
-    
-    float global_best_cost = FLT_MAX;
-    int global_best_path[MAX_NODES];
+    WorkerPool pool;
+    pool_init(&pool, g, task_type, result_type, trace);
+
+    METRICS_PHASE(metrics, PHASE_SEARCH)
+        pool_run(&pool, 1);
+
+    double t0 = trace_now(trace);
+    MPI_Send(pool.best, 1, result_type, 0, TAG_DONE, MPI_COMM_WORLD);
+    trace_event(trace, TRACE_SEND, t0, 0, TAG_DONE, 0, (long long) result_size(g->n), 0);
+    pool_free(&pool);
+}
+
+// expand prefixes breadth-first until every queued task has initial_depth cities,
+// subtrees that cannot beat the incumbent are dropped on the way
+static void *expand_prefixes(Graph *g, int initial_depth, float incumbent, size_t *q_head, size_t *q_tail)
+{
+    const int n = g->n;
+    size_t capacity = 1024;
+    void *queue = malloc(capacity * task_size(n));
+    *q_head = 0;
+    *q_tail = 0;
 
-    Task start_task = { .count = 1, .current_cost = 0, .lower_bound = 0 };
-    start_task.path[0] = 0;
-    queue[q_tail++] = start_task;
+    if (initial_depth > n) initial_depth = n;
 
-    while (q_head != q_tail) 
+    Task *start_task = task_at(queue, (*q_tail)++, n);
+    start_task->count = 1;
+    start_task->current_cost = 0;
+    start_task->lower_bound = 0;
+    start_task->upper_bound = incumbent;
+    start_task->path[0] = 0;
+
+    Task *t = (Task*) malloc(task_size(n));
+    char *visited = (char*) malloc(n);
+
+    while (*q_head != *q_tail) 
     {
-        if (queue[q_head].count >= initial_depth)
+        if (task_at(queue, *q_head, n)->count >= initial_depth)
             break; 
         
-        Task t = queue[q_head++];
-        int last_node = t.path[t.count - 1];
+        memcpy(t, task_at(queue, (*q_head)++, n), task_size(n));
+        int last_node = t->path[t->count - 1];
 
-        for (int i = 0; i < g->n; i++) 
+        memset(visited, 0, n);
+        for (int k = 0; k < t->count; k++) 
+            visited[t->path[k]] = 1;
+
+        for (int i = 0; i < n; i++) 
         {
-            int visited = 0;
-            for(int k = 0; k < t.count; k++) 
-                if(t.path[k] == i) visited = 1;
-            
-            if (!visited) 
+            if (visited[i]) continue;
+
+            if (*q_tail == capacity)
             {
-                Task next = t;
-                next.path[next.count] = i;
-                next.count++;
-                next.current_cost += g->dist[last_node][i];
-                next.lower_bound = compute_bound(g, &next);
-                
-                queue[q_tail++] = next;
+                capacity *= 2;
+                queue = realloc(queue, capacity * task_size(n));
             }
+
+            Task *next = task_at(queue, *q_tail, n);
+            memcpy(next, t, task_size(n));
+            next->path[next->count] = i;
+            next->count++;
+            next->current_cost += DIST(g, last_node, i);
+            next->lower_bound = compute_bound(g, next->path, next->count, next->current_cost);
+
+            if (next->lower_bound < incumbent)
+                (*q_tail)++;
         }
     }
 
-    int total_tasks = q_tail - q_head;
+    free(t);
+    free(visited);
+    return queue;
+}
+
+void master(int num_workers, Graph *g, MPI_Datatype task_type, MPI_Datatype result_type, int save, int initial_depth,
+            Metrics *metrics, Trace *trace) 
+{
+    const int n = g->n;
+
+    // warm start: a near-optimal incumbent lets B&B prune from the first node
+    float global_best_cost;
+    int *global_best_path = (int*) malloc(sizeof(int) * n);
+    METRICS_PHASE(metrics, PHASE_HEURISTIC)
+        global_best_cost = heuristic_tour(g, global_best_path);
+    printf("Heuristic Cost: %.4f\n", global_best_cost);
+
+    size_t q_head, q_tail;
+    void *queue;
+    METRICS_PHASE(metrics, PHASE_EXPAND)
+        queue = expand_prefixes(g, initial_depth, global_best_cost, &q_head, &q_tail);
+
+    size_t total_tasks = q_tail - q_head;
+    metrics_param_int(metrics, "subtrees", (long long) total_tasks);
+    metrics_start(metrics, PHASE_SEARCH);
 
     if (num_workers == 0) 
     {
-        while(q_head < q_tail) 
+        // no worker ranks, run the thread pool over the whole queue here
+        WorkerPool pool;
+        pool_init(&pool, g, task_type, result_type, trace);
+        pool_push(&pool, task_at(queue, q_head, n), total_tasks);
+        pool.no_more_work = 1;
+
+        pool_run(&pool, 0);
+
+        if (pool.best->cost < global_best_cost)
         {
-            Task t = queue[q_head++];
-            solve_subtree_recursive(g, t, &global_best_cost, global_best_path);
+            global_best_cost = pool.best->cost;
+            memcpy(global_best_path, pool.best->path, sizeof(int) * n);
         }
+        pool_free(&pool);
     }
     else
     {
-        // dispatch tasks
-        int tasks_sent = 0;
-        int tasks_completed = 0;
-        int active_workers = 0;
-    
-        // initial call
-        for (int w = 1; w <= num_workers; w++) 
-        {
-            if (q_head < q_tail) 
-            {
-                MPI_Send(&queue[q_head++], 1, task_type, w, TAG_TASK, MPI_COMM_WORLD);
-                tasks_sent++;
-                active_workers++;
-            }
-        }
-    
-        // dynamic loop
-        while (tasks_completed < total_tasks) 
+        SearchResult *res = (SearchResult*) malloc(result_size(n));
+        int workers_done = 0;
+
+        // workers ask for work by reporting their best tour, each request gets a
+        // guided-size batch, or TAG_KILL once the queue is drained
+        while (workers_done < num_workers) 
         {
-            SearchResult res;
             MPI_Status status;
+
+            // probe first so time spent idle is told apart from the receive itself
+            double t0 = trace_now(trace);
+            MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            trace_event(trace, TRACE_WAIT, t0, status.MPI_SOURCE, status.MPI_TAG, 0, 0, -1);
+
+            t0 = trace_now(trace);
+            MPI_Recv(res, 1, result_type, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
+            trace_event(trace, TRACE_RECV, t0, status.MPI_SOURCE, status.MPI_TAG, 0,
+                        (long long) result_size(n), (long long)(q_tail - q_head));
             
-            MPI_Recv(&res, 1, result_type, MPI_ANY_SOURCE, TAG_RESULT, MPI_COMM_WORLD, &status);
-            
-            active_workers--;
-            tasks_completed++;
-            
-            if (res.cost < global_best_cost) 
+            if (res->cost < global_best_cost) 
+            {
+                global_best_cost = res->cost;
+                memcpy(global_best_path, res->path, sizeof(int) * n);
+            }
+
+            if (status.MPI_TAG == TAG_DONE)
             {
-                global_best_cost = res.cost;
-                memcpy(global_best_path, res.path, sizeof(int) * g->n);
+                workers_done++;
+                continue;
             }
     
-            if (q_head < q_tail) 
+            size_t remaining = q_tail - q_head;
+            if (remaining > 0) 
+            {
+                size_t batch = remaining / (BATCH_FACTOR * (size_t) num_workers);
+                if (batch < 1) batch = 1;
+                if (batch > MAX_BATCH) batch = MAX_BATCH;
+
+                for (size_t i = 0; i < batch; i++)
+                    task_at(queue, q_head + i, n)->upper_bound = global_best_cost;
+
+                t0 = trace_now(trace);
+                MPI_Send(task_at(queue, q_head, n), (int) batch, task_type, status.MPI_SOURCE, TAG_TASK, MPI_COMM_WORLD);
+                q_head += batch;
+                trace_event(trace, TRACE_SEND, t0, status.MPI_SOURCE, TAG_TASK, (int) batch,
+                            (long long) batch * (long long) task_size(n), (long long)(q_tail - q_head));
+            }
+            else
             {
-                MPI_Send(&queue[q_head++], 1, task_type, status.MPI_SOURCE, TAG_TASK, MPI_COMM_WORLD);
-                active_workers++;
+                t0 = trace_now(trace);
+                MPI_Send(NULL, 0, task_type, status.MPI_SOURCE, TAG_KILL, MPI_COMM_WORLD);
+                trace_event(trace, TRACE_SEND, t0, status.MPI_SOURCE, TAG_KILL, 0, 0, 0);
             }
         }
-    
-        // cleanup
-        for (int w = 1; w <= num_workers; w++) 
-            MPI_Send(NULL, 0, MPI_INT, w, TAG_KILL, MPI_COMM_WORLD);
+
+        free(res);
     }
+    metrics_stop(metrics, PHASE_SEARCH);
     
     free(queue);
+    printf("Optimal Cost: %.4f (%zu subtrees)\n", global_best_cost, total_tasks);
 
     // save to file
     if (save)
     {
         save_coords("data/coords.txt", g);
-        save_solution("data/solution.txt", global_best_path, g->n, global_best_cost);
+        save_solution("data/solution.txt", global_best_path, n, global_best_cost);
     }
-}
\ No newline at end of file
+
+    free(global_best_path);
+}
@@ -0,0 +1,329 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// how coordinates turn into edge weights; TSPLIB instances round so that
+// their published optima are integers
+enum {
+    METRIC_EUCLID,   // plain distance, generated and coordinate-file graphs
+    METRIC_EUC_2D,   // TSPLIB EUC_2D: nint(distance)
+    METRIC_CEIL_2D   // TSPLIB CEIL_2D: distance rounded up
+};
+
+typedef struct {
+    int n;
+    int metric;
+    float* x;
+    float* y;
+    float* dist;     // n x n, row-major, NULL for large instances
+    float* min_edge; // cheapest edge leaving each city, filled with dist
+} Graph;
+
+#define DIST(g, i, j) ((g)->dist[(size_t)(i) * (size_t)(g)->n + (size_t)(j)])
+
+float calc_dist(int metric, float x1, float y1, float x2, float y2)
+{
+    if (metric == METRIC_EUCLID)
+        return sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2));
+
+    // TSPLIB rounds the double precision distance
+    double dx = (double) x1 - x2, dy = (double) y1 - y2;
+    double d = sqrt(dx * dx + dy * dy);
+    return metric == METRIC_CEIL_2D ? (float) ceil(d) : (float)(int)(d + 0.5);
+}
+
+// distance lookup that also works without a precomputed matrix
+static inline float graph_dist(const Graph* g, int i, int j)
+{
+    if (g->dist) return DIST(g, i, j);
+    return calc_dist(g->metric, g->x[i], g->y[i], g->x[j], g->y[j]);
+}
+
+void graph_alloc(Graph* g, int n)
+{
+    g->n = n;
+    g->metric = METRIC_EUCLID;
+    g->x = (float*) malloc((size_t) n * sizeof(float));
+    g->y = (float*) malloc((size_t) n * sizeof(float));
+    g->dist = NULL;
+    g->min_edge = NULL;
+}
+
+void graph_free(Graph* g)
+{
+    free(g->x);
+    free(g->y);
+    free(g->dist);
+    free(g->min_edge);
+    g->x = g->y = g->dist = g->min_edge = NULL;
+    g->n = 0;
+}
+
+// allocates the n x n matrix on first use
+void graph_compute_dist(Graph* g)
+{
+    if (g->dist == NULL)
+        g->dist = (float*) malloc((size_t) g->n * (size_t) g->n * sizeof(float));
+    if (g->min_edge == NULL)
+        g->min_edge = (float*) malloc((size_t) g->n * sizeof(float));
+
+    for (int i = 0; i < g->n; i++)
+    {
+        float min_edge = INFINITY;
+        for (int j = 0; j < g->n; j++)
+        {
+            DIST(g, i, j) = calc_dist(g->metric, g->x[i], g->y[i], g->x[j], g->y[j]);
+            if (j != i && DIST(g, i, j) < min_edge) min_edge = DIST(g, i, j);
+        }
+        g->min_edge[i] = min_edge;
+    }
+}
+
+// append one city, growing coordinate arrays geometrically
+static void graph_push(Graph* g, int* capacity, float x, float y)
+{
+    if (g->n == *capacity)
+    {
+        *capacity = *capacity ? 2 * *capacity : 64;
+        g->x = (float*) realloc(g->x, (size_t) *capacity * sizeof(float));
+        g->y = (float*) realloc(g->y, (size_t) *capacity * sizeof(float));
+    }
+    g->x[g->n] = x;
+    g->y[g->n] = y;
+    g->n++;
+}
+
+static int is_blank(const char* line)
+{
+    while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n') line++;
+    return *line == '\0';
+}
+
+// "id x y" and nothing after it
+static int parse_city(const char* line, float* x, float* y)
+{
+    int id, used = 0;
+    if (sscanf(line, "%d %f %f %n", &id, x, y, &used) != 3) return 0;
+    return line[used] == '\0';
+}
+
+// splits "KEY : VALUE" or "KEY VALUE" in place, returns the key or NULL for non-keyword lines
+static char* tsplib_keyword(char* line, char** value)
+{
+    char* key = line;
+    while (*key == ' ' || *key == '\t') key++;
+    if (!((*key >= 'A' && *key <= 'Z') || *key == '_')) return NULL;
+
+    char* end = key;
+    while ((*end >= 'A' && *end <= 'Z') || (*end >= '0' && *end <= '9') || *end == '_') end++;
+    char* rest = end;
+    while (*rest == ' ' || *rest == '\t' || *rest == ':') rest++;
+    *end = '\0';
+
+    char* tail = rest + strlen(rest);
+    while (tail > rest && (tail[-1] == ' ' || tail[-1] == '\t' || tail[-1] == '\r' || tail[-1] == '\n')) tail--;
+    *tail = '\0';
+    *value = rest;
+    return key;
+}
+
+// any of the specification's header keys marks a TSPLIB file
+static int is_tsplib_header(const char* key)
+{
+    static const char* keys[] = {
+        "NAME", "TYPE", "COMMENT", "DIMENSION", "EDGE_WEIGHT_TYPE", "EDGE_WEIGHT_FORMAT",
+        "NODE_COORD_SECTION", "EDGE_WEIGHT_SECTION"
+    };
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+        if (strcmp(key, keys[k]) == 0) return 1;
+    return 0;
+}
+
+// TSPLIB: "KEY : VALUE" header lines followed by NODE_COORD_SECTION with "id x y" rows;
+// only symmetric EUC_2D and CEIL_2D instances are supported
+static int load_tsplib(FILE* f, Graph* g)
+{
+    char line[512];
+    int dimension = -1;
+    int capacity = 0;
+    int has_type = 0, has_coords = 0;
+
+    while (fgets(line, sizeof(line), f))
+    {
+        char* value;
+        char* key = tsplib_keyword(line, &value);
+        if (key == NULL) continue;
+
+        if (strcmp(key, "TYPE") == 0 && strcmp(value, "TSP") != 0)
+        {
+            fprintf(stderr, "Unsupported TSPLIB problem type: %s\n", value);
+            return 0;
+        }
+        else if (strcmp(key, "EDGE_WEIGHT_TYPE") == 0)
+        {
+            if (strcmp(value, "CEIL_2D") == 0)
+                g->metric = METRIC_CEIL_2D;
+            else if (strcmp(value, "EUC_2D") == 0)
+                g->metric = METRIC_EUC_2D;
+            else
+            {
+                fprintf(stderr, "Unsupported TSPLIB edge weight type: %s\n", value);
+                return 0;
+            }
+            has_type = 1;
+        }
+        else if (strcmp(key, "DIMENSION") == 0)
+            dimension = atoi(value);
+        else if (strcmp(key, "NODE_COORD_SECTION") == 0)
+        {
+            has_coords = 1;
+            break;
+        }
+    }
+
+    if (!has_type || !has_coords)
+    {
+        fprintf(stderr, "TSPLIB file lacks %s\n", has_type ? "NODE_COORD_SECTION" : "EDGE_WEIGHT_TYPE");
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        float x, y;
+        if (strncmp(line, "EOF", 3) == 0) break;
+        if (is_blank(line)) continue;
+        if (!parse_city(line, &x, &y))
+        {
+            fprintf(stderr, "Malformed TSPLIB coordinate line: %s", line);
+            return 0;
+        }
+        graph_push(g, &capacity, x, y);
+    }
+
+    if (dimension > 0 && dimension != g->n)
+    {
+        fprintf(stderr, "TSPLIB DIMENSION is %d but %d coordinates were read\n", dimension, g->n);
+        return 0;
+    }
+    return 1;
+}
+
+// plain coordinate file as written by save_coords: "ID X Y" header then "id x y" rows
+static int load_coord_file(FILE* f, Graph* g)
+{
+    char line[512];
+    int capacity = 0;
+    int lineno = 0, header = 1;
+
+    while (fgets(line, sizeof(line), f))
+    {
+        float x, y;
+        lineno++;
+        if (is_blank(line)) continue;
+        if (parse_city(line, &x, &y))
+            graph_push(g, &capacity, x, y);
+        else if (!header)
+        {
+            fprintf(stderr, "Malformed coordinate line %d: %s", lineno, line);
+            return 0;
+        }
+        // only the first non-blank line may be a column header
+        header = 0;
+    }
+    return 1;
+}
+
+// load city coordinates from TSPLIB or coordinate file, distances are left to graph_compute_dist
+int load_graph(const char* filename, Graph* g)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL) {
+        perror("Error opening graph file");
+        return 0;
+    }
+
+    // TSPLIB files start with keyword lines, coordinate files with numbers or the ID X Y header
+    int tsplib = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        char* value;
+        char* key = tsplib_keyword(line, &value);
+        if (key != NULL && is_tsplib_header(key)) { tsplib = 1; break; }
+    }
+    rewind(f);
+
+    memset(g, 0, sizeof(Graph));
+    int ok = tsplib ? load_tsplib(f, g) : load_coord_file(f, g);
+    fclose(f);
+
+    if (ok && g->n < 2) {
+        fprintf(stderr, "Graph file %s contains fewer than 2 cities\n", filename);
+        ok = 0;
+    }
+    if (!ok) {
+        graph_free(g);
+        return 0;
+    }
+    return 1;
+}
+
+// send coordinates and metric from root to every rank
+void broadcast_graph(Graph* g, int root, MPI_Comm comm)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    int header[2] = { g->n, g->metric };
+    MPI_Bcast(header, 2, MPI_INT, root, comm);
+    int n = header[0];
+    if (rank != root)
+        graph_alloc(g, n);
+    g->metric = header[1];
+
+    MPI_Bcast(g->x, n, MPI_FLOAT, root, comm);
+    MPI_Bcast(g->y, n, MPI_FLOAT, root, comm);
+}
+
+void save_coords(const char* filename, Graph* g)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL) {
+        perror("Error opening coordinates file");
+        return;
+    }
+
+    fprintf(f, "ID\tX\tY\n");
+    for (int i = 0; i < g->n; i++)
+        fprintf(f, "%d\t%.4f\t%.4f\n", i, g->x[i], g->y[i]);
+
+
+    fclose(f);
+    printf("Coordinates saved to %s\n", filename);
+}
+
+void save_solution(const char* filename, int* path, int n, float cost)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL) {
+        perror("Error opening solution file");
+        return;
+    }
+
+    fprintf(f, "Optimal Cost: %.4f\n", cost);
+
+    for (int i = 0; i < n; i++)
+        fprintf(f, "%d ", path[i]);
+
+    fprintf(f, "%d\n", path[0]);
+
+    fclose(f);
+    printf("Solution saved to %s\n", filename);
+}
+
+#endif
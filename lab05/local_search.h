@@ -0,0 +1,419 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <stdint.h>
+
+#include "graph.h"
+#include "candidates.h"
+
+// gains are summed in double, where a few float distances add up exactly,
+// so moves that leave the tour length unchanged cancel to zero
+#define LS_EPS 1e-6
+#define LK_MAX_DEPTH 10   // 2-opt moves chained per Lin-Kernighan step
+#define LK_BREADTH 5      // alternatives tried for the first move
+#define OR_MAX_SEGMENT 3
+
+// array tour with position index; `reversed` flips orientation in O(1),
+// which lets flip() always reverse the shorter side of the cycle
+typedef struct {
+    int n;
+    int* order;
+    int* pos;
+    int reversed;
+} Tour;
+
+typedef struct {
+    const Graph* g;
+    const Candidates* cand;
+    Tour t;
+    int* queue;      // cities whose don't-look bit is off
+    char* queued;
+    int q_head, q_len;
+} Search;
+
+// xorshift64*, one state per thread
+static inline uint64_t rng_next(uint64_t* s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545F4914F6CDD1DULL;
+}
+
+static inline int rng_int(uint64_t* s, int bound)
+{
+    return (int)((rng_next(s) >> 33) % (uint64_t) bound);
+}
+
+static inline int tour_next(const Tour* t, int c)
+{
+    int p = t->pos[c] + (t->reversed ? -1 : 1);
+    if (p == t->n) p = 0;
+    if (p < 0) p = t->n - 1;
+    return t->order[p];
+}
+
+static inline int tour_prev(const Tour* t, int c)
+{
+    int p = t->pos[c] + (t->reversed ? 1 : -1);
+    if (p == t->n) p = 0;
+    if (p < 0) p = t->n - 1;
+    return t->order[p];
+}
+
+// reverse raw positions i..j (cyclic, inclusive)
+static void tour_reverse_raw(Tour* t, int i, int j, int len)
+{
+    for (int k = 0; k < len / 2; k++)
+    {
+        int a = t->order[i], b = t->order[j];
+        t->order[i] = b; t->pos[b] = i;
+        t->order[j] = a; t->pos[a] = j;
+        if (++i == t->n) i = 0;
+        if (--j < 0) j = t->n - 1;
+    }
+}
+
+// reverse the oriented path a -> ... -> b
+void tour_flip(Tour* t, int a, int b)
+{
+    int i = t->reversed ? t->pos[b] : t->pos[a];
+    int j = t->reversed ? t->pos[a] : t->pos[b];
+    int len = (j - i + t->n) % t->n + 1;
+
+    if (2 * len <= t->n)
+        tour_reverse_raw(t, i, j, len);
+    else
+    {
+        // reversing the complement and the orientation is the same cyclic tour
+        int ci = j + 1 == t->n ? 0 : j + 1;
+        int cj = i == 0 ? t->n - 1 : i - 1;
+        tour_reverse_raw(t, ci, cj, t->n - len);
+        t->reversed ^= 1;
+    }
+}
+
+void tour_from_array(Tour* t, const int* order, int n)
+{
+    t->n = n;
+    t->reversed = 0;
+    for (int i = 0; i < n; i++)
+    {
+        t->order[i] = order[i];
+        t->pos[order[i]] = i;
+    }
+}
+
+// oriented copy of the tour into out
+void tour_to_array(const Tour* t, int* out)
+{
+    int c = t->order[0];
+    for (int i = 0; i < t->n; i++)
+    {
+        out[i] = c;
+        c = tour_next(t, c);
+    }
+}
+
+double tour_length(const Graph* g, const Tour* t)
+{
+    double cost = 0.0;
+    for (int i = 0; i < t->n; i++)
+        cost += graph_dist(g, t->order[i], t->order[(i + 1) % t->n]);
+    return cost;
+}
+
+void search_init(Search* s, const Graph* g, const Candidates* cand)
+{
+    s->g = g;
+    s->cand = cand;
+    s->t.n = g->n;
+    s->t.order = (int*) malloc((size_t) g->n * sizeof(int));
+    s->t.pos = (int*) malloc((size_t) g->n * sizeof(int));
+    s->t.reversed = 0;
+    s->queue = (int*) malloc((size_t) g->n * sizeof(int));
+    s->queued = (char*) calloc((size_t) g->n, 1);
+    s->q_head = s->q_len = 0;
+}
+
+void search_free(Search* s)
+{
+    free(s->t.order);
+    free(s->t.pos);
+    free(s->queue);
+    free(s->queued);
+}
+
+static inline void search_push(Search* s, int c)
+{
+    if (s->queued[c]) return;
+    s->queued[c] = 1;
+    s->queue[(s->q_head + s->q_len++) % s->t.n] = c;
+}
+
+static inline int search_pop(Search* s)
+{
+    int c = s->queue[s->q_head];
+    s->q_head = (s->q_head + 1) % s->t.n;
+    s->q_len--;
+    s->queued[c] = 0;
+    return c;
+}
+
+// greedy nearest neighbour walk through candidate lists, falling back to a
+// linear scan only when every candidate of the current city is already used
+void nearest_neighbour_candidates(const Graph* g, const Candidates* cand, int start, int* order)
+{
+    char* used = (char*) calloc((size_t) g->n, 1);
+    int scan = 0;
+    order[0] = start;
+    used[start] = 1;
+
+    for (int k = 1; k < g->n; k++)
+    {
+        int last = order[k - 1];
+        int next = -1;
+        for (int c = 0; c < cand->k && next < 0; c++)
+        {
+            int j = cand->nbr[(size_t) last * cand->k + c];
+            if (!used[j]) next = j;
+        }
+
+        if (next < 0)
+        {
+            float best = 0.0f;
+            while (used[scan]) scan++;
+            for (int j = scan; j < g->n; j++)
+            {
+                if (used[j]) continue;
+                float d = graph_dist(g, last, j);
+                if (next < 0 || d < best) { next = j; best = d; }
+            }
+        }
+
+        order[k] = next;
+        used[next] = 1;
+    }
+    free(used);
+}
+
+// Lin-Kernighan step from t1 as a chain of sequential 2-opt moves: the edge
+// (t1, succ t1) is broken, each move adds (t2, t3) and breaks (t4, t3), and the
+// chain is rolled back to its most profitable prefix
+static int lk_step(Search* s, int t1, double* gain_out)
+{
+    const Graph* g = s->g;
+    const Candidates* cand = s->cand;
+    Tour* t = &s->t;
+
+    int flips[LK_MAX_DEPTH][2];
+
+    for (int alt = 0; alt < LK_BREADTH && alt < cand->k; alt++)
+    {
+        int t2 = tour_next(t, t1);
+        double G = graph_dist(g, t1, t2);
+        double best_gain = 0.0;
+        int best_depth = 0;
+        int depth = 0;
+
+        while (depth < LK_MAX_DEPTH)
+        {
+            int t3 = -1, t4 = -1;
+            double best_score = -1e30;
+            int rank = 0;
+
+            for (int c = 0; c < cand->k; c++)
+            {
+                int cand3 = cand->nbr[(size_t) t2 * cand->k + c];
+                double g1 = G - graph_dist(g, t2, cand3);
+                if (g1 <= LS_EPS) break; // candidates are sorted, no later one can help
+                if (cand3 == t1 || cand3 == tour_next(t, t2)) continue;
+
+                int cand4 = tour_prev(t, cand3);
+                double score = (double) graph_dist(g, cand4, cand3) - graph_dist(g, t2, cand3);
+
+                // first level walks alternatives in turn, deeper levels are greedy
+                if (depth == 0)
+                {
+                    if (rank++ == alt) { t3 = cand3; t4 = cand4; break; }
+                }
+                else if (score > best_score)
+                {
+                    best_score = score;
+                    t3 = cand3;
+                    t4 = cand4;
+                }
+            }
+            if (t3 < 0) break;
+
+            tour_flip(t, t2, t4);  // t1 t2..t4 t3 -> t1 t4..t2 t3
+            flips[depth][0] = t4;
+            flips[depth][1] = t2;
+            G += (double) graph_dist(g, t4, t3) - graph_dist(g, t2, t3);
+            depth++;
+
+            double closed = G - graph_dist(g, t4, t1);
+            if (closed > best_gain + LS_EPS)
+            {
+                best_gain = closed;
+                best_depth = depth;
+            }
+            t2 = t4;
+        }
+
+        // no alternative left at the first level
+        if (depth == 0) return 0;
+
+        // undo the unprofitable tail of the chain
+        while (depth > best_depth)
+        {
+            depth--;
+            tour_flip(t, flips[depth][0], flips[depth][1]);
+        }
+
+        if (best_depth > 0)
+        {
+            *gain_out = best_gain;
+            search_push(s, t1);
+            for (int k = 0; k < best_depth; k++)
+            {
+                search_push(s, flips[k][0]);
+                search_push(s, flips[k][1]);
+                search_push(s, tour_next(t, flips[k][1]));
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// move segment s1..s2 between a and b = next(a), reversed if asked,
+// done as two or three flips so the position index stays valid
+static void or_move(Tour* t, int s1, int s2, int a, int reversed)
+{
+    int nx = tour_next(t, s2);
+    tour_flip(t, s1, a);     // p a..nx s2..s1 b
+    tour_flip(t, a, nx);     // p nx..a s2..s1 b
+    if (!reversed)
+        tour_flip(t, s2, s1); // p nx..a s1..s2 b
+}
+
+// Or-opt from s1: relocate s1..s2 (1..OR_MAX_SEGMENT cities) next to a candidate
+static int or_step(Search* s, int s1, double* gain_out)
+{
+    const Graph* g = s->g;
+    const Candidates* cand = s->cand;
+    Tour* t = &s->t;
+
+    if (t->n < OR_MAX_SEGMENT + 3) return 0;
+
+    int s2 = s1;
+    for (int len = 1; len <= OR_MAX_SEGMENT; len++, s2 = tour_next(t, s2))
+    {
+        int p = tour_prev(t, s1), nx = tour_next(t, s2);
+        double removed = (double) graph_dist(g, p, s1) + graph_dist(g, s2, nx) - graph_dist(g, p, nx);
+        if (removed <= LS_EPS) continue;
+
+        for (int end = 0; end < (s1 == s2 ? 1 : 2); end++)
+        {
+            int e = end ? s2 : s1;
+            for (int c = 0; c < cand->k; c++)
+            {
+                int x = cand->nbr[(size_t) e * cand->k + c];
+                if (graph_dist(g, e, x) >= removed) break;
+
+                // x must lie outside the segment
+                int inside = 0;
+                for (int y = s1;; y = tour_next(t, y)) { if (y == x) inside = 1; if (y == s2) break; }
+                if (inside) continue;
+
+                // join e to x either on x's forward edge or its backward edge
+                for (int side = 0; side < 2; side++)
+                {
+                    int a = side ? tour_prev(t, x) : x;
+                    int b = tour_next(t, a);
+                    if (a == p || a == s2) continue;
+
+                    // forward insertion puts s1 next to a, reversed puts s2 next to a
+                    int reversed = (e == s1) != (side == 0);
+
+                    double added = reversed
+                        ? (double) graph_dist(g, a, s2) + graph_dist(g, s1, b) - graph_dist(g, a, b)
+                        : (double) graph_dist(g, a, s1) + graph_dist(g, s2, b) - graph_dist(g, a, b);
+
+                    if (added < removed - LS_EPS)
+                    {
+                        or_move(t, s1, s2, a, reversed);
+                        *gain_out = removed - added;
+                        int touched[6] = {p, nx, s1, s2, a, b};
+                        for (int k = 0; k < 6; k++) search_push(s, touched[k]);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// run Or-opt and LK moves until every city's don't-look bit is set
+double local_search(Search* s, double cost)
+{
+    while (s->q_len > 0)
+    {
+        int c = search_pop(s);
+        double gain = 0.0;
+
+        for (int dir = 0; dir < 2; dir++)
+        {
+            // flipping orientation lets the same code break the predecessor edge
+            s->t.reversed ^= 1;
+            if (lk_step(s, c, &gain) || or_step(s, c, &gain))
+            {
+                cost -= gain;
+                search_push(s, c);
+                break;
+            }
+        }
+    }
+    return cost;
+}
+
+// random double-bridge kick on the oriented tour, returns the new tour length
+double double_bridge(Search* s, double cost, uint64_t* rng, int* scratch)
+{
+    const int n = s->t.n;
+    int cut[3];
+    for (int k = 0; k < 3; k++) cut[k] = 1 + rng_int(rng, n - 1);
+    for (int a = 0; a < 3; a++)
+        for (int b = a + 1; b < 3; b++)
+            if (cut[b] < cut[a]) { int tmp = cut[a]; cut[a] = cut[b]; cut[b] = tmp; }
+    if (cut[0] == cut[1] || cut[1] == cut[2]) return cost;
+
+    // A B C D -> A C B D
+    tour_to_array(&s->t, scratch);
+    int* order = s->t.order;
+    int w = 0;
+    for (int i = 0; i < cut[0]; i++) order[w++] = scratch[i];
+    for (int i = cut[1]; i < cut[2]; i++) order[w++] = scratch[i];
+    for (int i = cut[0]; i < cut[1]; i++) order[w++] = scratch[i];
+    for (int i = cut[2]; i < n; i++) order[w++] = scratch[i];
+    for (int i = 0; i < n; i++) s->t.pos[order[i]] = i;
+    s->t.reversed = 0;
+
+    // A_end B_start B_end C_start C_end D_start
+    int ends[6] = {
+        scratch[cut[0] - 1], scratch[cut[0]], scratch[cut[1] - 1],
+        scratch[cut[1]], scratch[cut[2] - 1], scratch[cut[2]]
+    };
+    const Graph* g = s->g;
+    cost += (double) graph_dist(g, ends[0], ends[3]) + graph_dist(g, ends[4], ends[1])
+          + graph_dist(g, ends[2], ends[5])
+          - graph_dist(g, ends[0], ends[1]) - graph_dist(g, ends[2], ends[3])
+          - graph_dist(g, ends[4], ends[5]);
+
+    for (int k = 0; k < 6; k++) search_push(s, ends[k]);
+    return cost;
+}
+
+#endif
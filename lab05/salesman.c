@@ -4,65 +4,121 @@
 
 #define PI 3.14159265358979323846
 
-int main(int argc, char** argv) 
+// cities evenly spaced on a circle, shuffled so the optimal tour is not the identity
+void build_circle_graph(Graph* g, int n, float radius)
+{
+    graph_alloc(g, n);
+
+    for(int i = 0; i < g->n; i++)
+    {
+        float angle = (2.0 * PI * i) / (float) n;
+        g->x[i] = radius * cos(angle);
+        g->y[i] = radius * sin(angle);
+    }
+
+    srand(42);
+    for (int i = g->n - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        float temp_x = g->x[i]; g->x[i] = g->x[j]; g->x[j] = temp_x;
+        float temp_y = g->y[i]; g->y[i] = g->y[j]; g->y[j] = temp_y;
+    }
+}
+
+// usage: OMP_NUM_THREADS=<threads per rank> salesman [initial_depth] [graph_file]
+// set OMP_NUM_THREADS explicitly: unset, every rank starts one thread per core and
+// several ranks per node oversubscribe it. Open MPI also binds each rank to one
+// core, so give a threaded rank its cores, e.g. for 2 ranks of 4 threads:
+//     OMP_NUM_THREADS=4 mpiexec -n 2 --map-by slot:pe=4 ./salesman
+// (or --bind-to none to let the OS place the threads)
+// TRACE_FILE=<path> writes a Chrome trace of all messages and solved subtrees
+// graph_file is a TSPLIB (EUC_2D) instance or a coordinate file as written by save_coords,
+// without it a synthetic circle instance of N cities is solved
+int main(int argc, char** argv)
 {
     const float radius = 100.0f;
     const int N = 12;
     const int s = 0; // set to 1 to save graph x, y and solution into file
 
-    MPI_Init(&argc, &argv);
+    // worker threads take turns talking to master, never concurrently
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+#ifdef _OPENMP
+    if (provided < MPI_THREAD_SERIALIZED)
+    {
+        if (rank == 0) fprintf(stderr, "MPI lacks MPI_THREAD_SERIALIZED, running one thread per rank\n");
+        omp_set_num_threads(1);
+    }
+#endif
+
     int initial_depth = DEFAULT_INITIAL_DEPTH;
     if (argc > 1) {
         initial_depth = atoi(argv[1]);
         if (initial_depth < 1) initial_depth = 1;
     }
 
-    MPI_Datatype task_type;
-    create_task_type(&task_type);
-    MPI_Datatype result_type;
-    create_result_type(&result_type); 
-
-    Graph g; 
-    g.n = N;
-
-    for(int i = 0; i < g.n; i++)
+    Metrics metrics;
+    metrics_init(&metrics, "salesman", phase_names, PHASE_COUNT, MPI_COMM_WORLD);
+    metrics_param_int(&metrics, "depth", initial_depth);
+#ifdef _OPENMP
+    metrics_param_int(&metrics, "threads", omp_get_max_threads());
+#endif
+
+    // root builds or loads the graph, everyone else receives coordinates
+    metrics_start(&metrics, PHASE_SETUP);
+    Graph g = {0};
+    int loaded = 1;
+    if (rank == 0)
     {
-        float angle = (2.0 * PI * i) / (float) N;
-        g.x[i] = radius * cos(angle);
-        g.y[i] = radius * sin(angle);        
+        if (argc > 2) loaded = load_graph(argv[2], &g);
+        else build_circle_graph(&g, N, radius);
     }
 
-    srand(42);
-    for (int i = g.n - 1; i > 0; i--)
+    MPI_Bcast(&loaded, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!loaded)
     {
-        int j = rand() % (i + 1);
-        float temp_x = g.x[i]; g.x[i] = g.x[j]; g.x[j] = temp_x;
-        float temp_y = g.y[i]; g.y[i] = g.y[j]; g.y[j] = temp_y;
+        MPI_Finalize();
+        return EXIT_FAILURE;
     }
+    broadcast_graph(&g, 0, MPI_COMM_WORLD);
+    graph_compute_dist(&g);
 
-    for(int i=0; i<g.n; i++) 
-        for(int j=0; j<g.n; j++)
-            g.dist[i][j] = calc_dist(g.x[i], g.y[i], g.x[j], g.y[j]);
+    MPI_Datatype task_type;
+    create_task_type(&task_type, g.n);
+    MPI_Datatype result_type;
+    create_result_type(&result_type, g.n);
+    metrics_param_int(&metrics, "cities", g.n);
+    metrics_stop(&metrics, PHASE_SETUP);
 
-    MPI_Barrier(MPI_COMM_WORLD); 
+    // records only when TRACE_FILE is set, see trace.h
+    Trace trace;
+    trace_init(&trace, MPI_COMM_WORLD);
+
+    MPI_Barrier(MPI_COMM_WORLD);
     double start_time = MPI_Wtime();
 
-    if (rank == 0) master(size - 1, &g, task_type, result_type, s, initial_depth);
-    else worker(rank, &g, task_type, result_type);
+    if (rank == 0) master(size - 1, &g, task_type, result_type, s, initial_depth, &metrics, &trace);
+    else worker(&g, task_type, result_type, &metrics, &trace);
 
-    MPI_Barrier(MPI_COMM_WORLD); 
+    MPI_Barrier(MPI_COMM_WORLD);
     double end_time = MPI_Wtime();
 
     if (rank == 0)
         printf("Execution Time: %f seconds\n", end_time - start_time);
 
+    metrics_report(&metrics);
+    perf_counts_report(&search_perf, "solve_subtree_recursive", MPI_COMM_WORLD);
+    trace_report(&trace);
+    trace_free(&trace);
+
     MPI_Type_free(&task_type);
     MPI_Type_free(&result_type);
+    graph_free(&g);
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
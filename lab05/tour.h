@@ -0,0 +1,175 @@
+#ifndef TOUR_H
+#define TOUR_H
+
+#include "graph.h"
+
+#define TOUR_EPS 1e-4f
+#define HEURISTIC_STARTS 10
+#define OR_OPT_MAX_SEGMENT 3
+
+float tour_cost(const Graph* g, const int* tour)
+{
+    float cost = 0.0f;
+    for (int i = 0; i < g->n; i++)
+        cost += graph_dist(g, tour[i], tour[(i + 1) % g->n]);
+    return cost;
+}
+
+// rotate tour in place so that it starts at city 0, as B&B paths do
+void tour_rotate_to_zero(int* tour, int n)
+{
+    int k = 0;
+    while (tour[k] != 0) k++;
+    if (k == 0) return;
+
+    int* tmp = (int*) malloc((size_t) n * sizeof(int));
+    for (int i = 0; i < n; i++)
+        tmp[i] = tour[(i + k) % n];
+    memcpy(tour, tmp, (size_t) n * sizeof(int));
+    free(tmp);
+}
+
+void nearest_neighbour_tour(const Graph* g, int start, int* tour)
+{
+    char* visited = (char*) calloc((size_t) g->n, 1);
+    tour[0] = start;
+    visited[start] = 1;
+
+    for (int k = 1; k < g->n; k++)
+    {
+        int last = tour[k - 1];
+        int best = -1;
+        for (int i = 0; i < g->n; i++)
+            if (!visited[i] && (best < 0 || DIST(g, last, i) < DIST(g, last, best)))
+                best = i;
+        tour[k] = best;
+        visited[best] = 1;
+    }
+    free(visited);
+}
+
+// reverse tour[i..j]
+static void reverse_segment(int* tour, int i, int j)
+{
+    while (i < j)
+    {
+        int tmp = tour[i]; tour[i] = tour[j]; tour[j] = tmp;
+        i++; j--;
+    }
+}
+
+// first-improvement 2-opt over all edge pairs, returns 1 if the tour changed
+int two_opt(const Graph* g, int* tour)
+{
+    const int n = g->n;
+    int improved_any = 0;
+    int improved = 1;
+
+    while (improved)
+    {
+        improved = 0;
+        for (int i = 0; i < n - 2; i++)
+        {
+            int a = tour[i], b = tour[i + 1];
+            for (int j = i + 2; j < n; j++)
+            {
+                if (i == 0 && j == n - 1) continue; // same edge pair wrapped around
+
+                int c = tour[j], d = tour[(j + 1) % n];
+                float delta = DIST(g, a, c) + DIST(g, b, d) - DIST(g, a, b) - DIST(g, c, d);
+                if (delta < -TOUR_EPS)
+                {
+                    reverse_segment(tour, i + 1, j);
+                    b = tour[i + 1];
+                    improved = improved_any = 1;
+                }
+            }
+        }
+    }
+    return improved_any;
+}
+
+// move segment tour[i..i+len-1] between tour[j] and tour[j+1] (j outside the segment),
+// optionally reversed
+static void move_segment(int* tour, int n, int i, int len, int j, int reversed)
+{
+    int seg[OR_OPT_MAX_SEGMENT];
+    for (int k = 0; k < len; k++)
+        seg[k] = tour[reversed ? i + len - 1 - k : i + k];
+
+    // remove segment, then shift the insertion point if it was behind it
+    memmove(&tour[i], &tour[i + len], (size_t)(n - i - len) * sizeof(int));
+    if (j > i) j -= len;
+
+    memmove(&tour[j + 1 + len], &tour[j + 1], (size_t)(n - len - j - 1) * sizeof(int));
+    memcpy(&tour[j + 1], seg, (size_t) len * sizeof(int));
+}
+
+// Or-opt: relocate segments of 1..OR_OPT_MAX_SEGMENT cities, returns 1 if the tour changed
+int or_opt(const Graph* g, int* tour)
+{
+    const int n = g->n;
+    int improved_any = 0;
+    int improved = 1;
+
+    while (improved)
+    {
+        improved = 0;
+        for (int len = 1; len <= OR_OPT_MAX_SEGMENT && !improved; len++)
+        {
+            // segments never contain position 0, so they are contiguous in the array
+            for (int i = 1; i + len <= n && !improved; i++)
+            {
+                int prev = tour[i - 1];
+                int next = tour[(i + len) % n];
+                int s0 = tour[i], s1 = tour[i + len - 1];
+                float removed = DIST(g, prev, s0) + DIST(g, s1, next) - DIST(g, prev, next);
+
+                for (int j = 0; j < n && !improved; j++)
+                {
+                    if (j >= i - 1 && j <= i + len - 1) continue;
+
+                    int a = tour[j], b = tour[(j + 1) % n];
+                    float forward = DIST(g, a, s0) + DIST(g, s1, b) - DIST(g, a, b);
+                    float backward = DIST(g, a, s1) + DIST(g, s0, b) - DIST(g, a, b);
+
+                    if (forward < removed - TOUR_EPS || backward < removed - TOUR_EPS)
+                    {
+                        move_segment(tour, n, i, len, j, backward < forward);
+                        improved = improved_any = 1;
+                    }
+                }
+            }
+        }
+    }
+    return improved_any;
+}
+
+// nearest neighbour from several starts, each polished with 2-opt + Or-opt,
+// best tour (rotated to start at city 0) is written into tour
+float heuristic_tour(const Graph* g, int* tour)
+{
+    const int n = g->n;
+    int* candidate = (int*) malloc((size_t) n * sizeof(int));
+    float best = -1.0f;
+    int starts = n < HEURISTIC_STARTS ? n : HEURISTIC_STARTS;
+
+    for (int s = 0; s < starts; s++)
+    {
+        nearest_neighbour_tour(g, (int)((long long) s * n / starts), candidate);
+        while (two_opt(g, candidate) | or_opt(g, candidate));
+
+        float cost = tour_cost(g, candidate);
+        if (best < 0.0f || cost < best)
+        {
+            best = cost;
+            memcpy(tour, candidate, (size_t) n * sizeof(int));
+        }
+    }
+
+    free(candidate);
+    tour_rotate_to_zero(tour, n);
+    return best;
+}
+
+#endif
@@ -0,0 +1,367 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <mpi.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Message and task tracing for the master/worker search.
+//
+// Every rank records spans while it runs: solved subtrees, sends and receives
+// (with the number of tasks, bytes and the sender's or receiver's queue depth
+// afterwards) and the time spent blocked waiting for a message:
+//
+//     Trace trace;
+//     trace_init(&trace, MPI_COMM_WORLD);
+//     double t0 = trace_now(&trace);
+//     MPI_Send(...);
+//     trace_event(&trace, TRACE_SEND, t0, peer, tag, tasks, bytes, depth);
+//     trace_report(&trace);
+//
+// Recording is on only when $TRACE_FILE names an output file; otherwise every
+// call returns at once, and a NULL Trace* is accepted everywhere. trace_report
+// is collective: rank 0 gathers all events, writes them in Chrome trace format
+// (chrome://tracing, ui.perfetto.dev) with a flow arrow from every send to its
+// receive, and prints each rank's busy / wait / comm / idle breakdown.
+//
+// Times are relative to the barrier in trace_init on each rank, which is what
+// lines the ranks up; latencies across nodes are only as good as that barrier.
+
+#define TRACE_ENV "TRACE_FILE"
+#define TRACE_MAX_TAG 8
+
+enum {
+    TRACE_TASK,  // one solved subtree
+    TRACE_WAIT,  // blocked until a message arrived
+    TRACE_SEND,
+    TRACE_RECV,
+    TRACE_KINDS
+};
+static const char* trace_kind_names[TRACE_KINDS] = { "task", "wait", "send", "recv" };
+
+typedef struct {
+    double t0, t1;  // seconds since trace_init
+    int kind;
+    int thread;
+    int peer;       // other rank of a message, -1 otherwise
+    int tag;
+    int tasks;      // tasks carried by a message, 1 for a solved subtree
+    long long bytes;
+    long long depth;  // queue depth right after the event, -1 when not known
+} TraceEvent;
+
+typedef struct {
+    int enabled;
+    MPI_Comm comm;
+    double t_start;
+    TraceEvent* events;
+    size_t count, capacity;
+} Trace;
+
+static inline void trace_init(Trace* t, MPI_Comm comm)
+{
+    memset(t, 0, sizeof(*t));
+    t->comm = comm;
+
+    const char* path = getenv(TRACE_ENV);
+    t->enabled = path != NULL && path[0] != '\0';
+
+    MPI_Barrier(comm);
+    t->t_start = MPI_Wtime();
+}
+
+static inline int trace_on(const Trace* t)
+{
+    return t != NULL && t->enabled;
+}
+
+static inline double trace_now(const Trace* t)
+{
+    return trace_on(t) ? MPI_Wtime() - t->t_start : 0.0;
+}
+
+// records the span [t0, now] of the calling thread
+static inline void trace_event(Trace* t, int kind, double t0, int peer, int tag,
+                               int tasks, long long bytes, long long depth)
+{
+    if (!trace_on(t)) return;
+
+    TraceEvent e;
+    e.t0 = t0;
+    e.t1 = trace_now(t);
+    e.kind = kind;
+    e.thread = 0;
+#ifdef _OPENMP
+    e.thread = omp_get_thread_num();
+#endif
+    e.peer = peer;
+    e.tag = tag;
+    e.tasks = tasks;
+    e.bytes = bytes;
+    e.depth = depth;
+
+    #pragma omp critical(trace)
+    {
+        if (t->count == t->capacity)
+        {
+            size_t capacity = t->capacity ? 2 * t->capacity : 1024;
+            TraceEvent* events = (TraceEvent*) realloc(t->events, capacity * sizeof(TraceEvent));
+            if (events != NULL)
+            {
+                t->events = events;
+                t->capacity = capacity;
+            }
+        }
+        if (t->count < t->capacity)
+            t->events[t->count++] = e;
+    }
+}
+
+static inline void trace_free(Trace* t)
+{
+    free(t->events);
+    t->events = NULL;
+    t->count = t->capacity = 0;
+}
+
+static inline void trace_write_event(FILE* f, const TraceEvent* e, int rank, int* first)
+{
+    fprintf(f, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, "
+               "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"peer\": %d, \"tag\": %d, "
+               "\"tasks\": %d, \"bytes\": %lld, \"depth\": %lld}}",
+            *first ? "" : ",", trace_kind_names[e->kind], rank, e->thread,
+            e->t0 * 1e6, (e->t1 - e->t0) * 1e6, e->peer, e->tag, e->tasks, e->bytes, e->depth);
+    *first = 0;
+
+    if (e->depth >= 0)
+        fprintf(f, ",\n{\"name\": \"queue\", \"ph\": \"C\", \"pid\": %d, \"ts\": %.3f, "
+                   "\"args\": {\"depth\": %lld}}", rank, e->t1 * 1e6, e->depth);
+}
+
+static inline int trace_message_key(const TraceEvent* e, int size)
+{
+    return e->peer >= 0 && e->peer < size && e->tag >= 0 && e->tag < TRACE_MAX_TAG;
+}
+
+// messages between a pair on one tag are not overtaken, so the k-th send from
+// a to b with tag g is received by b's k-th receive from a with tag g. The
+// receives are bucketed once by (receiver, sender, tag), keeping their order,
+// and every send takes the next receive of its bucket: linear in the events
+static void trace_write_flows(FILE* f, const TraceEvent* events, const int* counts,
+                              const int* displs, int size)
+{
+    const size_t keys = (size_t) size * size * TRACE_MAX_TAG;
+    size_t* start = (size_t*) calloc(keys + 1, sizeof(size_t));
+    size_t* cursor = (size_t*) calloc(keys, sizeof(size_t));
+    size_t total = (size_t) displs[size - 1] + (size_t) counts[size - 1];
+    size_t* recvs = (size_t*) malloc((total ? total : 1) * sizeof(size_t));
+    if (start == NULL || cursor == NULL || recvs == NULL)
+    {
+        perror("Error allocating trace flow tables");
+        free(start); free(cursor); free(recvs);
+        return;
+    }
+
+    // bucket (d, s, g) of a receive on d from s, or of a send from s to d
+    #define TRACE_BUCKET(d, s, g) (((size_t)(d) * size + (size_t)(s)) * TRACE_MAX_TAG + (size_t)(g))
+
+    for (int d = 0; d < size; d++)
+        for (int i = 0; i < counts[d]; i++)
+        {
+            const TraceEvent* e = &events[displs[d] + i];
+            if (e->kind == TRACE_RECV && trace_message_key(e, size))
+                start[TRACE_BUCKET(d, e->peer, e->tag) + 1]++;
+        }
+    for (size_t k = 0; k < keys; k++)
+        start[k + 1] += start[k];
+    for (int d = 0; d < size; d++)
+        for (int i = 0; i < counts[d]; i++)
+        {
+            const TraceEvent* e = &events[displs[d] + i];
+            if (e->kind == TRACE_RECV && trace_message_key(e, size))
+            {
+                size_t b = TRACE_BUCKET(d, e->peer, e->tag);
+                recvs[start[b] + cursor[b]++] = (size_t) displs[d] + (size_t) i;
+            }
+        }
+
+    memset(cursor, 0, keys * sizeof(size_t));
+    long long flow_id = 0;
+    for (int r = 0; r < size; r++)
+        for (int i = 0; i < counts[r]; i++)
+        {
+            const TraceEvent* s = &events[displs[r] + i];
+            if (s->kind != TRACE_SEND || !trace_message_key(s, size)) continue;
+
+            size_t b = TRACE_BUCKET(s->peer, r, s->tag);
+            if (start[b] + cursor[b] >= start[b + 1]) continue;
+            const TraceEvent* e = &events[recvs[start[b] + cursor[b]++]];
+
+            fprintf(f, ",\n{\"name\": \"message\", \"cat\": \"message\", \"ph\": \"s\", \"id\": %lld, "
+                       "\"pid\": %d, \"tid\": %d, \"ts\": %.3f}", flow_id, r, s->thread, s->t0 * 1e6);
+            fprintf(f, ",\n{\"name\": \"message\", \"cat\": \"message\", \"ph\": \"f\", \"bp\": \"e\", "
+                       "\"id\": %lld, \"pid\": %d, \"tid\": %d, \"ts\": %.3f}",
+                    flow_id, s->peer, e->thread, e->t0 * 1e6);
+            flow_id++;
+        }
+    #undef TRACE_BUCKET
+
+    free(start);
+    free(cursor);
+    free(recvs);
+}
+
+// rank 0 only: all events, rank r's starting at events + displs[r]
+static int trace_write_chrome(const char* path, const TraceEvent* events, const int* counts,
+                              const int* displs, int size)
+{
+    FILE* f = fopen(path, "w");
+    if (f == NULL)
+    {
+        perror("Error opening trace file");
+        return 0;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    int first = 1;
+    for (int r = 0; r < size; r++)
+    {
+        fprintf(f, "%s\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+                   "\"args\": {\"name\": \"%s %d\"}}", first ? "" : ",", r, r == 0 ? "master" : "worker", r);
+        first = 0;
+        for (int i = 0; i < counts[r]; i++)
+            trace_write_event(f, &events[displs[r] + i], r, &first);
+    }
+
+    trace_write_flows(f, events, counts, displs, size);
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    return 1;
+}
+
+// rank 0 only: thread time of each rank split by what it was doing, over the
+// span from its first to its last event; idle is the rest (spinning on a lock,
+// a thread that found the deque empty, start-up and tear-down)
+static void trace_print_breakdown(const TraceEvent* events, const int* counts, const int* displs, int size)
+{
+    printf("[trace] %-6s %7s %9s %7s %7s %7s %7s %6s %6s %10s\n", "rank", "threads", "span (s)",
+           "busy", "wait", "comm", "idle", "sent", "recvd", "bytes in");
+
+    for (int r = 0; r < size; r++)
+    {
+        if (counts[r] == 0) continue;
+
+        double lo = events[displs[r]].t0, hi = events[displs[r]].t1;
+        double by_kind[TRACE_KINDS] = {0};
+        int threads = 1, sent = 0, recvd = 0;
+        long long bytes_in = 0;
+
+        for (int i = 0; i < counts[r]; i++)
+        {
+            const TraceEvent* e = &events[displs[r] + i];
+            if (e->t0 < lo) lo = e->t0;
+            if (e->t1 > hi) hi = e->t1;
+            if (e->thread + 1 > threads) threads = e->thread + 1;
+            by_kind[e->kind] += e->t1 - e->t0;
+            if (e->kind == TRACE_SEND) sent++;
+            if (e->kind == TRACE_RECV) { recvd++; bytes_in += e->bytes; }
+        }
+
+        const double total = (hi - lo) * threads;
+        const double comm = by_kind[TRACE_SEND] + by_kind[TRACE_RECV];
+        const double idle = total - by_kind[TRACE_TASK] - by_kind[TRACE_WAIT] - comm;
+        const double scale = total > 0.0 ? 100.0 / total : 0.0;
+        printf("[trace] %-6d %7d %9.4f %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6d %6d %10lld\n",
+               r, threads, hi - lo, by_kind[TRACE_TASK] * scale, by_kind[TRACE_WAIT] * scale,
+               comm * scale, (idle > 0.0 ? idle : 0.0) * scale, sent, recvd, bytes_in);
+    }
+}
+
+// collective over the init communicator
+static inline void trace_report(Trace* t)
+{
+    if (!t->enabled) return;
+
+    int rank, size;
+    MPI_Comm_rank(t->comm, &rank);
+    MPI_Comm_size(t->comm, &size);
+
+    // events travel as one opaque element each (identical layout on every rank
+    // of one build), so the counts are in events and only the total has to fit
+    MPI_Datatype event_type;
+    MPI_Type_contiguous((int) sizeof(TraceEvent), MPI_BYTE, &event_type);
+    MPI_Type_commit(&event_type);
+
+    long long count = (long long) t->count;
+    long long* counts_ll = NULL;
+    int *counts = NULL, *displs = NULL;
+    TraceEvent* all = NULL;
+
+    if (rank == 0)
+    {
+        counts_ll = (long long*) malloc((size_t) size * sizeof(long long));
+        counts = (int*) malloc((size_t) size * sizeof(int));
+        displs = (int*) malloc((size_t) size * sizeof(int));
+    }
+    MPI_Gather(&count, 1, MPI_LONG_LONG, counts_ll, 1, MPI_LONG_LONG, 0, t->comm);
+
+    int ok = 1;
+    if (rank == 0)
+    {
+        size_t total = 0;
+        ok = counts_ll != NULL && counts != NULL && displs != NULL;
+        for (int r = 0; ok && r < size; r++)
+        {
+            if (total + (size_t) counts_ll[r] > (size_t) INT_MAX)
+            {
+                fprintf(stderr, "Error: more than %d trace events, %s not written\n", INT_MAX, getenv(TRACE_ENV));
+                ok = 0;
+                break;
+            }
+            counts[r] = (int) counts_ll[r];
+            displs[r] = (int) total;
+            total += (size_t) counts_ll[r];
+        }
+        if (ok)
+        {
+            all = (TraceEvent*) malloc((total ? total : 1) * sizeof(TraceEvent));
+            if (all == NULL)
+            {
+                perror("Error allocating trace events");
+                ok = 0;
+            }
+        }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, t->comm);
+
+    if (ok)
+        MPI_Gatherv(t->events, (int) count, event_type, all, counts, displs, event_type, 0, t->comm);
+    MPI_Type_free(&event_type);
+
+    if (rank == 0 && !ok)
+    {
+        free(all);
+        free(counts_ll);
+        free(counts);
+        free(displs);
+        return;
+    }
+
+    if (rank == 0)
+    {
+        trace_write_chrome(getenv(TRACE_ENV), all, counts, displs, size);
+        trace_print_breakdown(all, counts, displs, size);
+        free(all);
+        free(counts_ll);
+        free(counts);
+        free(displs);
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+// Philox4x32-10 counter-based generator (Salmon et al., Random123): the output
+// depends only on (key, counter), so particle p at step s draws the same numbers
+// no matter which thread or lane simulates it
+namespace philox {
+    constexpr uint32_t M0 = 0xD2511F53u;
+    constexpr uint32_t M1 = 0xCD9E8D57u;
+    constexpr uint32_t W0 = 0x9E3779B9u;
+    constexpr uint32_t W1 = 0xBB67AE85u;
+    constexpr int rounds = 10;
+}
+
+struct philox4x32 {
+    uint32_t v[4];
+};
+
+static inline philox4x32 philox4x32_10(
+    uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+    uint32_t k0, uint32_t k1
+)
+{
+    for (int r = 0; r < philox::rounds; r++) {
+        uint64_t p0 = (uint64_t) philox::M0 * c0;
+        uint64_t p1 = (uint64_t) philox::M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t) p1;
+        c3 = (uint32_t) p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += philox::W0;
+        k1 += philox::W1;
+    }
+    return philox4x32{{c0, c1, c2, c3}};
+}
+
+// 32 random bits -> uniform in (0, 1], never 0 so log() stays finite
+static inline float uniform_open0(uint32_t x)
+{
+    return ((float)(x >> 8) + 1.0f) * (1.0f / 16777216.0f);
+}
+
+// Box-Muller: two uniforms -> two independent standard normals; the sine is
+// taken as a shifted cosine because gcc fuses a sinf/cosf pair into a complex
+// cexpi call the vectorizer cannot map to SIMD math routines
+static inline void box_muller(uint32_t a, uint32_t b, float* z0, float* z1)
+{
+    const float two_pi = 6.28318530717958647692f;
+    const float half_pi = 1.57079632679489661923f;
+    float r = sqrtf(-2.0f * logf(uniform_open0(a)));
+    float phi = two_pi * uniform_open0(b);
+    *z0 = r * cosf(phi);
+    *z1 = r * cosf(phi - half_pi);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+// on-line reductions for the drivers: each thread fills its own accumulators
+// and they are merged once at the end, so a run writes a few kilobytes of
+// summary no matter how many particles it simulated
+namespace summary_config {
+    constexpr int bins = 200;
+}
+
+// count, mean and central moment sums M2..M4 (Welford, merged with the
+// pairwise formulas of Pebay 2008), stable for any order of merges
+struct Moments {
+    long long n;
+    double mean, m2, m3, m4;
+    double min, max;
+};
+
+static inline void moments_init(Moments* m)
+{
+    memset(m, 0, sizeof(*m));
+    // finite sentinels: the CPU builds use -ffast-math, which lets the
+    // compiler assume no value is ever infinite
+    m->min = DBL_MAX;
+    m->max = -DBL_MAX;
+}
+
+static inline void moments_add(Moments* m, double x)
+{
+    const double n1 = (double) m->n;
+    const double n = n1 + 1.0;
+    const double delta = x - m->mean;
+    const double delta_n = delta / n;
+    const double delta_n2 = delta_n * delta_n;
+    const double term = delta * delta_n * n1;
+
+    m->n++;
+    m->mean += delta_n;
+    m->m4 += term * delta_n2 * (n * n - 3.0 * n + 3.0) + 6.0 * delta_n2 * m->m2 - 4.0 * delta_n * m->m3;
+    m->m3 += term * delta_n * (n - 2.0) - 3.0 * delta_n * m->m2;
+    m->m2 += term;
+    if (x < m->min) m->min = x;
+    if (x > m->max) m->max = x;
+}
+
+static inline void moments_merge(Moments* a, const Moments* b)
+{
+    if (b->n == 0) return;
+    if (a->n == 0) { *a = *b; return; }
+
+    const double na = (double) a->n, nb = (double) b->n, n = na + nb;
+    const double d = b->mean - a->mean, d2 = d * d;
+
+    double m4 = a->m4 + b->m4
+        + d2 * d2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+        + 6.0 * d2 * (na * na * b->m2 + nb * nb * a->m2) / (n * n)
+        + 4.0 * d * (na * b->m3 - nb * a->m3) / n;
+    double m3 = a->m3 + b->m3
+        + d2 * d * na * nb * (na - nb) / (n * n)
+        + 3.0 * d * (na * b->m2 - nb * a->m2) / n;
+    double m2 = a->m2 + b->m2 + d2 * na * nb / n;
+
+    a->n += b->n;
+    a->mean += d * nb / n;
+    a->m2 = m2;
+    a->m3 = m3;
+    a->m4 = m4;
+    if (b->min < a->min) a->min = b->min;
+    if (b->max > a->max) a->max = b->max;
+}
+
+static inline double moments_variance(const Moments* m)
+{
+    return m->n > 1 ? m->m2 / (double)(m->n - 1) : 0.0;
+}
+
+static inline double moments_skewness(const Moments* m)
+{
+    return m->m2 > 0.0 ? sqrt((double) m->n) * m->m3 / pow(m->m2, 1.5) : 0.0;
+}
+
+// excess kurtosis, 0 for a normal distribution
+static inline double moments_kurtosis(const Moments* m)
+{
+    return m->m2 > 0.0 ? (double) m->n * m->m4 / (m->m2 * m->m2) - 3.0 : 0.0;
+}
+
+// summary_config::bins equal bins over [lo, hi], the last one closed so that hi
+// itself is binned; values outside are only counted
+struct Histogram {
+    double lo, hi, scale;
+    long long under, over;
+    long long counts[summary_config::bins];
+};
+
+static inline void histogram_init(Histogram* h, double lo, double hi)
+{
+    memset(h, 0, sizeof(*h));
+    h->lo = lo;
+    h->hi = hi;
+    h->scale = summary_config::bins / (hi - lo);
+}
+
+static inline void histogram_add(Histogram* h, double x)
+{
+    if (x < h->lo) { h->under++; return; }
+    if (x > h->hi) { h->over++; return; }
+    int b = (int)((x - h->lo) * h->scale);
+    h->counts[b < summary_config::bins ? b : summary_config::bins - 1]++;
+}
+
+static inline void histogram_merge(Histogram* a, const Histogram* b)
+{
+    a->under += b->under;
+    a->over += b->over;
+    for (int i = 0; i < summary_config::bins; i++)
+        a->counts[i] += b->counts[i];
+}
+
+// "key": {...} members of the summary JSON, written without a trailing comma
+static inline void json_moments(FILE* f, const char* key, const Moments* m)
+{
+    fprintf(f, "  \"%s\": {\"n\": %lld, \"mean\": %.17g, \"variance\": %.17g, "
+               "\"skewness\": %.17g, \"kurtosis\": %.17g, \"min\": %.17g, \"max\": %.17g}",
+            key, m->n, m->mean, moments_variance(m), moments_skewness(m), moments_kurtosis(m),
+            m->n > 0 ? m->min : 0.0, m->n > 0 ? m->max : 0.0);
+}
+
+static inline void json_histogram(FILE* f, const char* key, const Histogram* h)
+{
+    fprintf(f, "  \"%s\": {\"lo\": %.17g, \"hi\": %.17g, \"under\": %lld, \"over\": %lld, \"counts\": [",
+            key, h->lo, h->hi, h->under, h->over);
+    for (int i = 0; i < summary_config::bins; i++)
+        fprintf(f, i ? ", %lld" : "%lld", h->counts[i]);
+    fprintf(f, "]}");
+}
@@ -48,7 +48,8 @@ void naive_kernel(
 float* generate_naive(
     const int n,
     const float tau,
-    const float dt
+    const float dt,
+    const uint64_t seed = (uint64_t) time(NULL)
 )
 {
     const float dt_sqrt = sqrtf(dt);
@@ -60,7 +61,7 @@ float* generate_naive(
     cudaMalloc(&d_states, n * sizeof(curandState));
 
     int blocks = (n + config::threads - 1) / config::threads;
-    init_rng_kernel<<<blocks, config::threads>>>(d_states, time(NULL), n);
+    init_rng_kernel<<<blocks, config::threads>>>(d_states, seed, n);
     cudaDeviceSynchronize();
 
     const int steps = (int)(tau / dt);
@@ -88,7 +89,7 @@ void sum_rows_kernel(
     if (row >= n) return;
 
     float acc = 0.0f;
-    int base = row * steps;
+    size_t base = (size_t) row * steps;
 
     for (int j = 0; j < steps; ++j)
         acc += d_normal[base + j];
@@ -99,14 +100,15 @@ void sum_rows_kernel(
 float* generate_batchrand(
     const int n,
     const float tau,
-    const float dt
+    const float dt,
+    const uint64_t seed = (uint64_t) time(NULL)
 )
 {
     const int steps = (int)(tau / dt);
     const float dt_sqrt = sqrtf(dt);
-    const size_t total = (size_t)(n * steps);
+    const size_t total = (size_t) n * steps;
     const size_t bytes_normal = total * sizeof(float);
-    const size_t bytes_vec    = (size_t)(n * sizeof(float));
+    const size_t bytes_vec    = (size_t) n * sizeof(float);
 
     float *d_normal = nullptr, *d_x = nullptr, *h_x = nullptr;
 
@@ -115,7 +117,7 @@ float* generate_batchrand(
 
     curandGenerator_t gen;
     curandCreateGenerator(&gen, CURAND_RNG_PSEUDO_DEFAULT);
-    curandSetPseudoRandomGeneratorSeed(gen, (unsigned long long) time(NULL));
+    curandSetPseudoRandomGeneratorSeed(gen, (unsigned long long) seed);
     curandGenerateNormal(gen, d_normal, total, 0.0f, 1.0f);
 
     int blocks = (n + config::threads - 1) / config::threads;
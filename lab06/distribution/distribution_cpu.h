@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/philox.h"
+#include "distribution_summary.h"
+
+namespace stream_config {
+    constexpr int chunk = 256;    // particles per work item, sums + noise stay in L1
+    constexpr int block = 4;      // steps per Philox call (4 normals per particle)
+}
+
+// fold steps normals into the running sums of particles [first, first + count);
+// first is a multiple of stream_config::chunk, so the high counter word is shared
+static void stream_chunk(
+    float* __restrict__ x,
+    const long long first,
+    const int count,
+    const int steps,
+    const float dt_sqrt,
+    const uint32_t k0,
+    const uint32_t k1
+)
+{
+    constexpr int C = stream_config::chunk;
+    const uint32_t id_lo = (uint32_t) first, id_hi = (uint32_t)((uint64_t) first >> 32);
+
+    float acc[C];
+    float noise[stream_config::block][C];
+
+    for (int l = 0; l < C; l++)
+        acc[l] = 0.0f;
+
+    for (int s = 0; s < steps; s += stream_config::block) {
+        // normals for (particle, steps s..s+3) come from counter (id, s / 4)
+        #pragma omp simd
+        for (int l = 0; l < C; l++) {
+            philox4x32 r = philox4x32_10(
+                id_lo + (uint32_t) l, id_hi, (uint32_t) s / stream_config::block, 0u, k0, k1
+            );
+            box_muller(r.v[0], r.v[1], &noise[0][l], &noise[1][l]);
+            box_muller(r.v[2], r.v[3], &noise[2][l], &noise[3][l]);
+        }
+
+        const int rem = steps - s < stream_config::block ? steps - s : stream_config::block;
+        for (int b = 0; b < rem; b++) {
+            #pragma omp simd
+            for (int l = 0; l < C; l++)
+                acc[l] += noise[b][l];
+        }
+    }
+
+    for (int l = 0; l < count; l++)
+        x[l] = acc[l] * dt_sqrt;
+}
+
+// same result as generate_batchrand (x[i] = sqrt(dt) * sum of steps normals) but
+// the normals are consumed as they are generated: memory is the n outputs plus
+// one chunk of scratch per thread, and n is only bounded by the output array
+float* generate_streaming(
+    const long long n,
+    const float tau,
+    const float dt,
+    const uint64_t seed = (uint64_t) time(NULL)
+)
+{
+    const int steps = (int)(tau / dt);
+    const float dt_sqrt = sqrtf(dt);
+    const uint32_t k0 = (uint32_t) seed, k1 = (uint32_t)(seed >> 32);
+    const long long chunks = (n + stream_config::chunk - 1) / stream_config::chunk;
+
+    float* h_x = (float*) malloc((size_t) n * sizeof(float));
+    if (h_x == NULL) return NULL;
+
+    #pragma omp parallel for schedule(static)
+    for (long long c = 0; c < chunks; c++) {
+        long long first = c * stream_config::chunk;
+        int count = n - first < stream_config::chunk ? (int)(n - first) : stream_config::chunk;
+        stream_chunk(&h_x[first], first, count, steps, dt_sqrt, k0, k1);
+    }
+
+    return h_x;
+}
+
+// reduction-only run: each chunk is reduced into the thread's summary while it
+// is still in cache, and no per-particle vector is kept
+void generate_streaming_summary(
+    DistSummary* summary,
+    const long long n,
+    const float tau,
+    const float dt,
+    const uint64_t seed = (uint64_t) time(NULL)
+)
+{
+    const int steps = (int)(tau / dt);
+    const float dt_sqrt = sqrtf(dt);
+    const uint32_t k0 = (uint32_t) seed, k1 = (uint32_t)(seed >> 32);
+    const long long chunks = (n + stream_config::chunk - 1) / stream_config::chunk;
+
+    dist_summary_init(summary, tau);
+
+    #pragma omp parallel
+    {
+        DistSummary local;
+        dist_summary_init(&local, tau);
+        float x[stream_config::chunk];
+
+        #pragma omp for schedule(static)
+        for (long long c = 0; c < chunks; c++) {
+            long long first = c * stream_config::chunk;
+            int count = n - first < stream_config::chunk ? (int)(n - first) : stream_config::chunk;
+            stream_chunk(x, first, count, steps, dt_sqrt, k0, k1);
+            for (int l = 0; l < count; l++)
+                dist_summary_add(&local, x[l]);
+        }
+
+        #pragma omp critical(dist_summary)
+        dist_summary_merge(summary, &local);
+    }
+}
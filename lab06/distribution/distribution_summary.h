@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdio.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/summary.h"
+
+// histogram range in standard deviations of N(0, tau); the rest lands in under/over
+namespace dist_summary_config {
+    constexpr double sigmas = 6.0;
+}
+
+struct DistSummary {
+    Moments x;
+    Histogram hist;
+};
+
+static inline void dist_summary_init(DistSummary* s, const float tau)
+{
+    const double r = dist_summary_config::sigmas * sqrt((double) tau);
+    moments_init(&s->x);
+    histogram_init(&s->hist, -r, r);
+}
+
+static inline void dist_summary_add(DistSummary* s, const float x)
+{
+    moments_add(&s->x, x);
+    histogram_add(&s->hist, x);
+}
+
+static inline void dist_summary_merge(DistSummary* a, const DistSummary* b)
+{
+    moments_merge(&a->x, &b->x);
+    histogram_merge(&a->hist, &b->hist);
+}
+
+// host-side reduction of a result vector, for the device methods
+static void dist_summary_from_array(DistSummary* s, const float* x, const long long n, const float tau)
+{
+    dist_summary_init(s, tau);
+
+    #pragma omp parallel
+    {
+        DistSummary local;
+        dist_summary_init(&local, tau);
+
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < n; i++)
+            dist_summary_add(&local, x[i]);
+
+        #pragma omp critical(dist_summary)
+        dist_summary_merge(s, &local);
+    }
+}
+
+static int dist_summary_write(const char* filename, const DistSummary* s, const float tau, const float dt)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL) {
+        perror("Error opening summary file");
+        return 0;
+    }
+
+    fprintf(f, "{\n  \"n\": %lld,\n  \"tau\": %.9g,\n  \"dt\": %.9g,\n", s->x.n, tau, dt);
+    json_moments(f, "x", &s->x);
+    fprintf(f, ",\n");
+    json_histogram(f, "histogram", &s->hist);
+    fprintf(f, "\n}\n");
+
+    fclose(f);
+    return 1;
+}
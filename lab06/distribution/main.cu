@@ -1,58 +1,113 @@
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+// nvcc builds all methods, a plain C++ compiler only the streaming one:
+//   nvcc distribution/main.cu -o main -lcurand -O3 -Xcompiler -fopenmp
+//   g++ -x c++ distribution/main.cu -o main -O3 -march=native -ffast-math -fopenmp
+#ifdef __CUDACC__
 #include "distribution.cuh"
+#endif
+#include "distribution_cpu.h"
+#include "distribution_summary.h"
 
 typedef enum {
     METHOD_NAIVE,
     METHOD_BATCH,
+    METHOD_STREAM,
     METHOD_UNKNOWN
 } MethodType;
 
 MethodType get_method(const char* str) {
     if (strcmp(str, "naive") == 0) return METHOD_NAIVE;
     if (strcmp(str, "batch") == 0) return METHOD_BATCH;
+    if (strcmp(str, "stream") == 0) return METHOD_STREAM;
     return METHOD_UNKNOWN;
 }
 
+// save: 0 = nothing, 1 = raw positions (data/results_distribution.bin),
+//       2 = reduced summary only (data/summary_distribution.json)
+// seed defaults to the clock and is printed; stream reproduces every particle
+// for a given seed whatever the thread count, the device methods draw from
+// cuRAND and agree with it only in distribution
 int main(int argc, char** argv)
 {
-    if (argc != 4) {
-        printf("Usage: %s <n> <method> <save>\n", argv[0]);
-        printf("Example: %s 1000 naive 1\n", argv[0]);
+    if (argc < 4 || argc > 5) {
+        printf("Usage: %s <n> <method> <save> [seed]\n", argv[0]);
+        printf("Example: %s 1000 naive 1 42\n", argv[0]);
         return 1;
     }
 
-    int n = atoi(argv[1]);
+    long long n = atoll(argv[1]);
     char *method_str = argv[2];
     int save = atoi(argv[3]);
 
     const float TAU = 2.5f;
     const float DT = 0.01f;
 
+    MethodType method = get_method(method_str);
+    const uint64_t seed = argc > 4 ? (uint64_t) strtoull(argv[4], NULL, 10) : (uint64_t) time(NULL);
+    printf("Seed: %llu\n", (unsigned long long) seed);
     float *x = NULL;
-    switch (get_method(method_str)) {
+    DistSummary summary;
+
+    // the streaming engine reduces in place and never holds the n results
+    if (method == METHOD_STREAM && save == 2) {
+        generate_streaming_summary(&summary, n, TAU, DT, seed);
+        return dist_summary_write("data/summary_distribution.json", &summary, TAU, DT) ? 0 : 1;
+    }
+
+    // the device methods index particles with int
+    if ((method == METHOD_NAIVE || method == METHOD_BATCH) && n > INT_MAX) {
+        printf("Method %s supports n <= %d, use stream\n", method_str, INT_MAX);
+        return 1;
+    }
+
+    switch (method) {
+#ifdef __CUDACC__
         case METHOD_NAIVE:
-            x = generate_naive(n, TAU, DT);
+            x = generate_naive((int) n, TAU, DT, seed);
             break;
 
         case METHOD_BATCH:
-            x = generate_batchrand(n, TAU, DT);
+            x = generate_batchrand((int) n, TAU, DT, seed);
+            break;
+#endif
+
+        case METHOD_STREAM:
+            x = generate_streaming(n, TAU, DT, seed);
             break;
 
         default:
-            printf("Pick method from [naive, batch]\n");
+#ifdef __CUDACC__
+            printf("Pick method from [naive, batch, stream]\n");
+#else
+            printf("Pick method from [stream] (naive and batch need nvcc)\n");
+#endif
             return 1;
     }
 
-    if (save && x != NULL) {
+    if (x == NULL) {
+        printf("Could not allocate results for %lld particles\n", n);
+        return 1;
+    }
+
+    if (save == 1) {
         FILE *f = fopen("data/results_distribution.bin", "wb");
         if (f) {
-            fwrite(x, sizeof(float), n, f); 
+            fwrite(x, sizeof(float), (size_t) n, f);
             fclose(f);
         }
     }
 
+    if (save == 2) {
+        dist_summary_from_array(&summary, x, n, TAU);
+        dist_summary_write("data/summary_distribution.json", &summary, TAU, DT);
+    }
+
+    free(x);
     return 0;
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
+import shutil
 import subprocess
 import time
 import matplotlib.pyplot as plt
 
 def compile_code():
     print("Compiling...")
-    subprocess.run(["nvcc", "distribution/main.cu", "-o", "main", "-lcurand", "-O3"])
+    if BACKEND == "cuda":
+        subprocess.run(["nvcc", "distribution/main.cu", "-o", "main", "-lcurand", "-O3",
+                        "-Xcompiler", "-fopenmp"])
+    else:
+        subprocess.run(["g++", "-x", "c++", "distribution/main.cu", "-o", "main",
+                        "-O3", "-march=native", "-ffast-math", "-fopenmp"])
     print("Compilation successful.")
 
 def run_benchmark(n, method):
@@ -23,9 +29,10 @@ def run_benchmark(n, method):
     return avg_time
 
 
+BACKEND = "cuda" if shutil.which("nvcc") else "cpu"
 EXECUTABLE = "./main"
 N_VALUES = [1e5, 5e5, 1e6, 5e6, 1e7, 5e7, 1e8]
-METHODS = ["naive", "batch"]
+METHODS = ["naive", "batch", "stream"] if BACKEND == "cuda" else ["stream"]
 RUNS_PER_DATAPOINT = 5
 
 compile_code()
@@ -49,7 +56,7 @@ for method in METHODS:
 plt.xscale('log')
 plt.xlabel('N (Number of particles)')
 plt.ylabel('Time (seconds)')
-plt.title('CUDA Random Walk Performance: Naive vs Batch')
+plt.title(f'Random Walk Performance ({BACKEND}): ' + ' vs '.join(m.capitalize() for m in METHODS))
 plt.grid(True, which="both", ls="-", alpha=0.2)
 plt.legend()
 
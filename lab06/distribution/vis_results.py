@@ -1,24 +1,61 @@
+import json
+import os
+import sys
 import matplotlib.pyplot as plt
 import numpy as np
 
+SUMMARY_FILE = "data/summary_distribution.json"
+RAW_FILE = "data/results_distribution.bin"
+
 TAU = 2.5 
 
-data = np.fromfile("data/results.bin", dtype=np.float32)
+# usage: vis_results.py [summary .json or raw .bin]
+# without an argument the newer of the engine's reduced summary (save = 2) and
+# the raw positions (save = 1) is plotted, so an older run never shadows a newer one
+def pick_input():
+    if len(sys.argv) > 1:
+        return sys.argv[1]
+    present = [p for p in (SUMMARY_FILE, RAW_FILE) if os.path.exists(p)]
+    return max(present, key=os.path.getmtime) if present else RAW_FILE
+
+INPUT_FILE = pick_input()
+print(f"Input:     {INPUT_FILE}")
+
+if INPUT_FILE.endswith(".json"):
+    with open(INPUT_FILE) as f:
+        summary = json.load(f)
+    TAU = summary["tau"]
+    n, moments = summary["n"], summary["x"]
+    hist = np.array(summary["histogram"]["counts"], dtype=np.float64)
+    bin_edges = np.linspace(summary["histogram"]["lo"], summary["histogram"]["hi"], len(hist) + 1)
+    counts = hist / (n * np.diff(bin_edges))
+    x_min, x_max = moments["min"], moments["max"]
+else:
+    data = np.fromfile(INPUT_FILE, dtype=np.float32)
+    n = len(data)
+    moments = {"mean": data.mean(), "variance": data.var(ddof=1)}
+    counts, bin_edges = np.histogram(data, bins=200, density=True)
+    x_min, x_max = data.min(), data.max()
 
-counts, bin_edges = np.histogram(data, bins=200, density=True)
 bin_centers = (bin_edges[:-1] + bin_edges[1:]) / 2
+print(f"N:         {n}")
+print(f"Mean:      {moments['mean']:.6f} (expected 0)")
+print(f"Variance:  {moments['variance']:.6f} (expected {TAU})")
+if "kurtosis" in moments:
+    print(f"Skewness:  {moments['skewness']:.6f} (expected 0)")
+    print(f"Kurtosis:  {moments['kurtosis']:.6f} (excess, expected 0)")
 
 plt.figure(figsize=(10, 6))
 
 plt.fill_between(bin_centers, counts, alpha=0.6, color='#007acc', label='Generated Data')
 plt.step(bin_centers, counts, where='mid', color='#005a9e', linewidth=1)
 
-x = np.linspace(data.min(), data.max(), 100)
+x = np.linspace(x_min, x_max, 100)
 p = (1 / np.sqrt(2 * np.pi * TAU)) * np.exp(-x**2 / (2 * TAU))
 
 plt.plot(x, p, 'r', linewidth=2, label=r"$N(0, \tau)$")
 
-plt.title(f"Distribution of Generated Random Numbers (N={len(data)})")
+plt.title(f"Distribution of Generated Random Numbers (N={n})")
 plt.legend()
 plt.grid(True, linestyle='--', alpha=0.3)
 
@@ -0,0 +1,88 @@
+import json
+import shutil
+import subprocess
+import time
+import matplotlib.pyplot as plt
+import numpy as np
+
+def compile_code():
+    print("Compiling...")
+    if BACKEND == "cuda":
+        subprocess.run(["nvcc", "escape/main.cu", "-o", "main", "-lcurand", "-O3"])
+    else:
+        subprocess.run(["g++", "-x", "c++", "escape/main.cu", "-o", "main",
+                        "-O3", "-march=native", "-ffast-math", "-fopenmp"])
+    print("Compilation successful.")
+
+def survival_tau(t, n_terms=200):
+    t = np.atleast_1d(t).astype(np.float64)
+
+    m = np.arange(n_terms, dtype=np.float64)
+    coeff = (-1.0)**m / (2.0 * m + 1.0)
+    lam = ((2.0 * m + 1.0)**2) * (np.pi**2) / 8.0
+
+    exponents = np.exp(-lam[:, None] * t[None, :])
+    return (4.0 / np.pi) * np.dot(coeff, exponents)
+
+# one summary run; the error is the largest deviation of the survival curve
+# from the series solution over the histogram edges (t > 0)
+def run_point(dt, scheme):
+    cmd = [EXECUTABLE, str(N), "2", str(dt), scheme]
+
+    t = time.perf_counter()
+    subprocess.run(cmd, capture_output=True, text=True)
+    t = time.perf_counter() - t
+
+    with open(SUMMARY_FILE) as f:
+        summary = json.load(f)
+    hist = summary["histogram"]
+    edges = np.linspace(hist["lo"], hist["hi"], len(hist["counts"]) + 1)
+    survival = np.array(summary["survival"], dtype=np.float64) / summary["n"]
+    error = np.max(np.abs(survival[1:] - survival_tau(edges[1:])))
+    return t, error
+
+
+BACKEND = "cuda" if shutil.which("nvcc") else "cpu"
+EXECUTABLE = "./main"
+SUMMARY_FILE = "data/summary_escape.json"
+N = 1000000
+# steps that divide the histogram bin width (5 / 200), so every edge is a step time
+DT_VALUES = [1e-4, 2.5e-4, 1e-3, 2.5e-3, 5e-3, 1.25e-2, 2.5e-2]
+SCHEMES = ["discrete", "bridge"]
+
+compile_code()
+
+# Monte Carlo noise floor of the survival estimate, max over t of sqrt(S(1-S)/N)
+noise_floor = 0.5 / np.sqrt(N)
+
+results = {scheme: {"time": [], "error": []} for scheme in SCHEMES}
+
+print(f"{'dt':<10} {'Scheme':<10} {'Time (s)':<12} {'Max |S - S_exact|':<18}")
+print("-" * 52)
+
+for dt in DT_VALUES:
+    for scheme in SCHEMES:
+        t, error = run_point(dt, scheme)
+        results[scheme]["time"].append(t)
+        results[scheme]["error"].append(error)
+        print(f"{dt:<10g} {scheme:<10} {t:<12.4f} {error:.6f}")
+
+fig, (ax_dt, ax_cost) = plt.subplots(1, 2, figsize=(14, 6))
+
+for scheme in SCHEMES:
+    ax_dt.loglog(DT_VALUES, results[scheme]["error"], marker='o', label=scheme)
+    ax_cost.loglog(results[scheme]["time"], results[scheme]["error"], marker='o', label=scheme)
+
+for ax in (ax_dt, ax_cost):
+    ax.axhline(noise_floor, color='gray', ls='--', label='MC noise (N)')
+    ax.set_ylabel('Max survival error')
+    ax.grid(True, which="both", ls="-", alpha=0.2)
+    ax.legend()
+
+ax_dt.set_xlabel('dt')
+ax_dt.set_title(f'{BACKEND.upper()} Escape: error vs time step (N={N})')
+ax_cost.set_xlabel('Time (seconds)')
+ax_cost.set_title('Error vs run time')
+
+plt.tight_layout()
+plt.savefig('data/convergence_escape_plot.png', dpi=150)
@@ -5,6 +5,8 @@
 #include <math.h>
 #include <stdio.h>
 
+#include "escape_scheme.h"
+
 namespace config {
     constexpr int threads = 1024;
 }
@@ -48,10 +50,43 @@ void simulation_kernel(
     }
 }
 
+// same walk, but a step also ends the walk when the Brownian bridge between
+// its endpoints crosses a barrier
+__global__ 
+void bridge_kernel(
+    int* __restrict__ t,
+    curandState* __restrict__ globalState,
+    const float dt_sqrt,
+    const float neg_two_inv_dt,
+    const int n,
+    const int T
+)
+{
+    int tx = blockDim.x * blockIdx.x + threadIdx.x;
+    if (tx >= n) return;
+
+    curandState localState = globalState[tx];
+    float val = 0.0f;
+
+    for (int i = 0; i < T; i++) {
+        float noise = curand_normal(&localState);
+        float next = val + dt_sqrt * noise;
+
+        if (next < -1.0f || next > 1.0f ||
+            curand_uniform(&localState) <= bridge_cross_prob(val, next, neg_two_inv_dt)) {
+            t[tx] = i + 1;
+            return;
+        }
+        val = next;
+    }
+}
+
 int* simulate(
     const int n,
     const float dt,
-    const int T
+    const int T,
+    const EscapeScheme scheme = SCHEME_DISCRETE,
+    const uint64_t seed = (uint64_t) time(NULL)
 )
 {
     const float dt_sqrt = sqrtf(dt);
@@ -65,12 +100,17 @@ int* simulate(
     cudaMalloc(&d_states, n * sizeof(curandState));
 
     int blocks = (n + config::threads - 1) / config::threads;
-    init_rng_kernel<<<blocks, config::threads>>>(d_states, time(NULL), n);
+    init_rng_kernel<<<blocks, config::threads>>>(d_states, seed, n);
     cudaDeviceSynchronize();
 
-    simulation_kernel<<<blocks, config::threads>>>(
-        d_x, d_states, dt_sqrt, n, T
-    );
+    if (scheme == SCHEME_BRIDGE)
+        bridge_kernel<<<blocks, config::threads>>>(
+            d_x, d_states, dt_sqrt, -2.0f / dt, n, T
+        );
+    else
+        simulation_kernel<<<blocks, config::threads>>>(
+            d_x, d_states, dt_sqrt, n, T
+        );
     cudaDeviceSynchronize();
 
     int *h_x = (int*) malloc(bytes);
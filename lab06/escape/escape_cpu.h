@@ -0,0 +1,198 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/philox.h"
+#include "escape_scheme.h"
+#include "escape_summary.h"
+
+namespace cpu_config {
+    constexpr int lanes = 16;     // particles advanced together by one thread
+    constexpr int block = 4;      // steps per Philox call (4 normals per lane)
+    constexpr int claim = 4096;   // particle ids taken from the shared counter at once
+}
+
+// per-thread source of particle ids, refilled from a shared counter
+struct ParticleSource {
+    long long next;
+    long long end;
+};
+
+static inline long long claim_particle(ParticleSource* src, long long* shared_next, long long n)
+{
+    if (src->next == src->end) {
+        long long start;
+        #pragma omp atomic capture
+        { start = *shared_next; *shared_next += cpu_config::claim; }
+        if (start >= n) return -1;
+        src->next = start;
+        src->end = start + cpu_config::claim < n ? start + cpu_config::claim : n;
+    }
+    return src->next++;
+}
+
+// lane-parallel Brownian walk: each of cpu_config::lanes slots holds one particle,
+// and a slot whose particle escaped or ran out of steps is refilled with a fresh
+// one, so long-lived walkers never leave the other lanes idle; the two lane loops
+// are kept branch-free and 32-bit so the compiler maps them onto SIMD registers;
+// finished particles go to t, to the thread's summary acc, or to both
+static void simulate_thread(
+    int* __restrict__ t,
+    EscapeSummary* acc,
+    long long* shared_next,
+    const long long n,
+    const float dt,
+    const int T,
+    const EscapeScheme scheme,
+    const uint64_t seed
+)
+{
+    constexpr int L = cpu_config::lanes;
+    const uint32_t k0 = (uint32_t) seed, k1 = (uint32_t)(seed >> 32);
+    const float dt_sqrt = sqrtf(dt);
+    const float neg_two_inv_dt = -2.0f / dt;
+
+    ParticleSource src = {0, 0};
+    long long id[L];
+    uint32_t id_lo[L], id_hi[L];
+    int step[L];
+    float val[L];
+    int live = 0;
+
+    for (int l = 0; l < L; l++) {
+        id[l] = claim_particle(&src, shared_next, n);
+        id_lo[l] = (uint32_t) id[l];
+        id_hi[l] = (uint32_t)((uint64_t) id[l] >> 32);
+        step[l] = 0;
+        val[l] = 0.0f;
+        if (id[l] >= 0) live++;
+    }
+
+    while (live > 0) {
+        float noise[cpu_config::block][L];
+        float uniform[cpu_config::block][L];
+        int escaped_at[L];
+
+        // normal for (particle, step) comes from counter (id, step / 4, 0)
+        #pragma omp simd
+        for (int l = 0; l < L; l++) {
+            philox4x32 r = philox4x32_10(
+                id_lo[l], id_hi[l], (uint32_t) step[l] / cpu_config::block, 0u, k0, k1
+            );
+            box_muller(r.v[0], r.v[1], &noise[0][l], &noise[1][l]);
+            box_muller(r.v[2], r.v[3], &noise[2][l], &noise[3][l]);
+        }
+
+        // masks are kept as 0/1 ints multiplied in, which gcc vectorizes where
+        // the equivalent branches or bool selects are left scalar
+        if (scheme == SCHEME_DISCRETE) {
+            #pragma omp simd
+            for (int l = 0; l < L; l++) {
+                float v = val[l];
+                int s = step[l];
+                int inside = 1;
+                for (int b = 0; b < cpu_config::block; b++) {
+                    int moving = inside & (s < T);
+                    v += dt_sqrt * noise[b][l] * (float) moving;
+                    s += moving;
+                    inside = moving ? (fabsf(v) <= 1.0f) : inside;
+                }
+                val[l] = v;
+                step[l] = s;
+                escaped_at[l] = s * (1 - inside);
+            }
+        } else {
+            // bridge uniforms for the same 4 steps come from counter (id, step / 4, 1)
+            #pragma omp simd
+            for (int l = 0; l < L; l++) {
+                philox4x32 r = philox4x32_10(
+                    id_lo[l], id_hi[l], (uint32_t) step[l] / cpu_config::block, 1u, k0, k1
+                );
+                for (int b = 0; b < cpu_config::block; b++)
+                    uniform[b][l] = uniform_open0(r.v[b]);
+            }
+
+            #pragma omp simd
+            for (int l = 0; l < L; l++) {
+                float v = val[l];
+                int s = step[l];
+                int inside = 1;
+                for (int b = 0; b < cpu_config::block; b++) {
+                    int moving = inside & (s < T);
+                    float next = v + dt_sqrt * noise[b][l];
+                    int stay = (fabsf(next) <= 1.0f) & (uniform[b][l] > bridge_cross_prob(v, next, neg_two_inv_dt));
+                    v += dt_sqrt * noise[b][l] * (float) moving;
+                    s += moving;
+                    inside = moving ? stay : inside;
+                }
+                val[l] = v;
+                step[l] = s;
+                escaped_at[l] = s * (1 - inside);
+            }
+        }
+
+        // retire finished particles (escape time, or 0 if still trapped at T) and refill
+        for (int l = 0; l < L; l++) {
+            if (id[l] < 0) continue;
+            if (escaped_at[l] == 0 && step[l] < T) continue;
+
+            if (t != NULL) t[id[l]] = escaped_at[l];
+            if (acc != NULL) escape_summary_add(acc, escaped_at[l], dt);
+            id[l] = claim_particle(&src, shared_next, n);
+            id_lo[l] = (uint32_t) id[l];
+            id_hi[l] = (uint32_t)((uint64_t) id[l] >> 32);
+            step[l] = 0;
+            val[l] = 0.0f;
+            if (id[l] < 0) live--;
+        }
+    }
+}
+
+// CPU counterpart of simulate() in escape.cuh: t[i] = step of first exit from
+// [-1, 1] (1-based), 0 if particle i is still inside after T steps
+int* simulate(
+    const int n,
+    const float dt,
+    const int T,
+    const EscapeScheme scheme = SCHEME_DISCRETE,
+    const uint64_t seed = (uint64_t) time(NULL)
+)
+{
+    int* h_x = (int*) malloc((size_t) n * sizeof(int));
+    if (h_x == NULL) return NULL;
+    long long shared_next = 0;
+
+    #pragma omp parallel
+    simulate_thread(h_x, NULL, &shared_next, n, dt, T, scheme, seed);
+
+    return h_x;
+}
+
+// reduction-only run: no per-particle vector, so n is bounded by time alone
+void simulate_summary(
+    EscapeSummary* summary,
+    const long long n,
+    const float dt,
+    const int T,
+    const EscapeScheme scheme = SCHEME_DISCRETE,
+    const uint64_t seed = (uint64_t) time(NULL)
+)
+{
+    long long shared_next = 0;
+    escape_summary_init(summary, dt, T);
+
+    #pragma omp parallel
+    {
+        EscapeSummary local;
+        escape_summary_init(&local, dt, T);
+        simulate_thread(NULL, &local, &shared_next, n, dt, T, scheme, seed);
+
+        #pragma omp critical(escape_summary)
+        escape_summary_merge(summary, &local);
+    }
+}
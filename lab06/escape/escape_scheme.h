@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string.h>
+#include <math.h>
+
+#ifdef __CUDACC__
+#define ESCAPE_HD __host__ __device__
+#else
+#define ESCAPE_HD
+#endif
+
+// SCHEME_DISCRETE checks the barriers only at the end of each step, which
+// misses excursions in between and needs a small dt; SCHEME_BRIDGE also tests
+// the Brownian bridge between the two endpoints, so escape probabilities at
+// step times stay accurate with much larger steps
+enum EscapeScheme {
+    SCHEME_DISCRETE,
+    SCHEME_BRIDGE,
+    SCHEME_UNKNOWN
+};
+
+static inline EscapeScheme get_scheme(const char* str)
+{
+    if (strcmp(str, "discrete") == 0) return SCHEME_DISCRETE;
+    if (strcmp(str, "bridge") == 0) return SCHEME_BRIDGE;
+    return SCHEME_UNKNOWN;
+}
+
+// probability that a Brownian path from x0 to x1 (both inside [-1, 1]) over a
+// step of variance dt touches a barrier: exp(-2 (b - x0)(b - x1) / dt) per
+// barrier, combined as independent events (the double-barrier series differs
+// only in terms of order exp(-8 / dt)); exponents are clamped at -80 because
+// vector expf drops to a slow scalar path on underflow, and e^-80 is already
+// far below the smallest uniform the generator can return
+static inline ESCAPE_HD float bridge_cross_prob(const float x0, const float x1, const float neg_two_inv_dt)
+{
+    float p_up = expf(fmaxf(neg_two_inv_dt * (1.0f - x0) * (1.0f - x1), -80.0f));
+    float p_down = expf(fmaxf(neg_two_inv_dt * (1.0f + x0) * (1.0f + x1), -80.0f));
+    return p_up + p_down - p_up * p_down;
+}
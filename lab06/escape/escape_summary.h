@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/summary.h"
+
+// escape times in time units (step * dt) of the particles that left [-1, 1],
+// and how many were still inside after T steps
+struct EscapeSummary {
+    long long trapped;
+    Moments times;
+    Histogram hist;
+};
+
+static inline void escape_summary_init(EscapeSummary* s, const float dt, const int T)
+{
+    s->trapped = 0;
+    moments_init(&s->times);
+    histogram_init(&s->hist, 0.0, (double) dt * T);
+}
+
+// step is the escape step as stored by simulate(), 0 for a trapped particle
+static inline void escape_summary_add(EscapeSummary* s, const int step, const float dt)
+{
+    if (step == 0) {
+        s->trapped++;
+        return;
+    }
+    double t = (double) step * dt;
+    moments_add(&s->times, t);
+    // binned at the middle of the step it left in, so an escape at a step
+    // ending exactly on a bin edge is counted before that edge
+    histogram_add(&s->hist, t - 0.5 * dt);
+}
+
+static inline void escape_summary_merge(EscapeSummary* a, const EscapeSummary* b)
+{
+    a->trapped += b->trapped;
+    moments_merge(&a->times, &b->times);
+    histogram_merge(&a->hist, &b->hist);
+}
+
+// host-side reduction of a result vector, for engines that only return t
+static void escape_summary_from_array(EscapeSummary* s, const int* t, const long long n,
+                                      const float dt, const int T)
+{
+    escape_summary_init(s, dt, T);
+
+    #pragma omp parallel
+    {
+        EscapeSummary local;
+        escape_summary_init(&local, dt, T);
+
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < n; i++)
+            escape_summary_add(&local, t[i], dt);
+
+        #pragma omp critical(escape_summary)
+        escape_summary_merge(s, &local);
+    }
+}
+
+// survival[k] counts particles still inside at the k-th histogram edge, i.e.
+// trapped ones plus those escaping in a later bin; the last entry is trapped
+static int escape_summary_write(const char* filename, const EscapeSummary* s,
+                                const long long n, const float dt, const int T)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL) {
+        perror("Error opening summary file");
+        return 0;
+    }
+
+    fprintf(f, "{\n  \"n\": %lld,\n  \"dt\": %.9g,\n  \"T\": %d,\n", n, dt, T);
+    fprintf(f, "  \"escaped\": %lld,\n  \"trapped\": %lld,\n", s->times.n, s->trapped);
+    json_moments(f, "escape_time", &s->times);
+    fprintf(f, ",\n");
+    json_histogram(f, "histogram", &s->hist);
+    fprintf(f, ",\n  \"survival\": [");
+
+    long long inside = n;
+    for (int k = 0; k <= summary_config::bins; k++) {
+        fprintf(f, k ? ", %lld" : "%lld", inside);
+        if (k < summary_config::bins) inside -= s->hist.counts[k];
+    }
+    fprintf(f, "]\n}\n");
+
+    fclose(f);
+    return 1;
+}
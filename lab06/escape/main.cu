@@ -1,32 +1,85 @@
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+// nvcc builds the CUDA engine, a plain C++ compiler the multi-core CPU one:
+//   nvcc escape/main.cu -o main -lcurand -O3
+//   g++ -x c++ escape/main.cu -o main -O3 -march=native -ffast-math -fopenmp
+#ifdef __CUDACC__
 #include "escape.cuh"
+#else
+#include "escape_cpu.h"
+#endif
+#include "escape_summary.h"
 
+// save: 0 = nothing, 1 = raw escape steps (data/results_escape.bin),
+//       2 = reduced summary only (data/summary_escape.json)
+// dt and scheme (discrete | bridge) are optional; the horizon stays T_FINAL.
+// seed defaults to the clock and is printed; on the CPU engine a given seed
+// reproduces every particle exactly, whatever the thread count (the summary's
+// moments up to the rounding of their merge order)
 int main(int argc, char** argv)
 {
-    if (argc != 3) {
-        printf("Usage: %s <n> <save>\n", argv[0]);
-        printf("Example: %s 1000 1\n", argv[0]);
+    if (argc < 3 || argc > 6) {
+        printf("Usage: %s <n> <save> [dt] [scheme] [seed]\n", argv[0]);
+        printf("Example: %s 1000 1 0.01 bridge 42\n", argv[0]);
         return 1;
     }
 
-    int n = atoi(argv[1]);
+    long long n = atoll(argv[1]);
     int save = atoi(argv[2]);
 
-    const float DT = 0.0001f;
-    const int T = 50000;
+    const float T_FINAL = 5.0f;
+    const float DT = argc > 3 ? (float) atof(argv[3]) : 0.0001f;
+    const int T = (int) lroundf(T_FINAL / DT);
 
-    int *x = simulate(n, DT, T);
+    EscapeScheme scheme = argc > 4 ? get_scheme(argv[4]) : SCHEME_DISCRETE;
+    if (scheme == SCHEME_UNKNOWN || DT <= 0.0f) {
+        printf("Pick dt > 0 and scheme from [discrete, bridge]\n");
+        return 1;
+    }
+
+    const uint64_t seed = argc > 5 ? (uint64_t) strtoull(argv[5], NULL, 10) : (uint64_t) time(NULL);
+    printf("Seed: %llu\n", (unsigned long long) seed);
+
+    EscapeSummary summary;
+
+#ifndef __CUDACC__
+    // the CPU engine reduces in place and never holds the n results
+    if (save == 2) {
+        simulate_summary(&summary, n, DT, T, scheme, seed);
+        return escape_summary_write("data/summary_escape.json", &summary, n, DT, T) ? 0 : 1;
+    }
+#endif
+
+    if (n > INT_MAX) {
+        printf("Per-particle results support n <= %d, use save = 2\n", INT_MAX);
+        return 1;
+    }
 
-    if (save && x != NULL) {
+    int *x = simulate((int) n, DT, T, scheme, seed);
+    if (x == NULL) {
+        printf("Could not allocate results for %lld particles\n", n);
+        return 1;
+    }
+
+    if (save == 1) {
         FILE *f = fopen("data/results_escape.bin", "wb");
         if (f) {
-            fwrite(x, sizeof(int), n, f); 
+            fwrite(x, sizeof(int), (size_t) n, f);
             fclose(f);
         }
     }
 
+    if (save == 2) {
+        escape_summary_from_array(&summary, x, n, DT, T);
+        escape_summary_write("data/summary_escape.json", &summary, n, DT, T);
+    }
+
+    free(x);
     return 0;
-}
\ No newline at end of file
+}
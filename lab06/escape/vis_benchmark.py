@@ -1,10 +1,15 @@
+import shutil
 import subprocess
 import time
 import matplotlib.pyplot as plt
 
 def compile_code():
     print("Compiling...")
-    subprocess.run(["nvcc", "escape/main.cu", "-o", "main", "-lcurand", "-O3"])
+    if BACKEND == "cuda":
+        subprocess.run(["nvcc", "escape/main.cu", "-o", "main", "-lcurand", "-O3"])
+    else:
+        subprocess.run(["g++", "-x", "c++", "escape/main.cu", "-o", "main",
+                        "-O3", "-march=native", "-ffast-math", "-fopenmp"])
     print("Compilation successful.")
 
 def run_benchmark(n):
@@ -23,6 +28,7 @@ def run_benchmark(n):
     return avg_time
 
 
+BACKEND = "cuda" if shutil.which("nvcc") else "cpu"
 EXECUTABLE = "./main"
 N_VALUES = [1e5, 5e5, 1e6, 5e6, 1e7, 5e7, 1e8]
 RUNS_PER_DATAPOINT = 5
@@ -46,7 +52,7 @@ plt.plot(N_VALUES, results, marker='o', label="Escape sim time")
 plt.xscale('log')
 plt.xlabel('N (Number of particles)')
 plt.ylabel('Time t [s]')
-plt.title('CUDA Escape simulation')
+plt.title(f'{BACKEND.upper()} Escape simulation')
 plt.grid(True, which="both", ls="-", alpha=0.2)
 plt.legend()
 
@@ -1,19 +1,50 @@
+import json
+import os
+import sys
 import matplotlib.pyplot as plt
 import numpy as np
 
-data = np.fromfile("data/results_escape.bin", dtype=np.int32)
-
-escaped = data[data > 0]
-not_escaped = len(data) - len(escaped)
-
-print(f"Total:     {len(data)}")
-print(f"Escaped:   {len(escaped)}")
-print(f"Trapped:   {not_escaped}")
+SUMMARY_FILE = "data/summary_escape.json"
+RAW_FILE = "data/results_escape.bin"
 
 DT = 1e-4
 T = 50000
+BINS = 200
+
+# usage: vis_results.py [summary .json or raw .bin]
+# without an argument the newer of the engine's reduced summary (save = 2) and
+# the raw steps (save = 1) is plotted, so an older run never shadows a newer one
+def pick_input():
+    if len(sys.argv) > 1:
+        return sys.argv[1]
+    present = [p for p in (SUMMARY_FILE, RAW_FILE) if os.path.exists(p)]
+    return max(present, key=os.path.getmtime) if present else RAW_FILE
+
+INPUT_FILE = pick_input()
+print(f"Input:     {INPUT_FILE}")
+
+if INPUT_FILE.endswith(".json"):
+    with open(INPUT_FILE) as f:
+        summary = json.load(f)
+    DT, T = summary["dt"], summary["T"]
+    total, n_escaped, not_escaped = summary["n"], summary["escaped"], summary["trapped"]
+    counts = np.array(summary["histogram"]["counts"], dtype=np.float64)
+    edges = np.linspace(summary["histogram"]["lo"], summary["histogram"]["hi"], len(counts) + 1)
+    survival = np.array(summary["survival"], dtype=np.float64) / total
+else:
+    data = np.fromfile(INPUT_FILE, dtype=np.int32)
+    escaped = data[data > 0]
+    total, n_escaped, not_escaped = len(data), len(escaped), len(data) - len(escaped)
+    counts, edges = np.histogram((escaped - 0.5) * DT, bins=BINS, range=(0.0, DT * T))
+    counts = counts.astype(np.float64)
+    survival = 1.0 - np.concatenate(([0.0], np.cumsum(counts))) / total
+
+print(f"Total:     {total}")
+print(f"Escaped:   {n_escaped}")
+print(f"Trapped:   {not_escaped}")
+
 T_final = DT * T
-t_samples = escaped * DT
+density = counts / (n_escaped * np.diff(edges))
 
 def survival_tau(t, n_terms=200):
     t = np.atleast_1d(t).astype(np.float64)
@@ -47,19 +78,19 @@ f_grid = pdf_tau(t_grid)
 
 f_cond = f_grid / p_escape_theory
 
-plt.figure(figsize=(10, 6))
+fig, (ax_pdf, ax_surv) = plt.subplots(1, 2, figsize=(14, 6))
 
-plt.hist(
-    t_samples,
-    bins=200,
-    density=True,
+ax_pdf.stairs(
+    density,
+    edges,
+    fill=True,
     color='#ff7f0e',
     edgecolor='black',
     alpha=0.6,
     label='Simulation'
 )
 
-plt.plot(
+ax_pdf.plot(
     t_grid,
     f_cond,
     'k',
@@ -67,11 +98,19 @@ plt.plot(
     label='Theoretical (first exit pdf)'
 )
 
-plt.title("Distribution of First Passage Times")
-plt.xlabel("Time t")
-plt.ylabel("Density")
-plt.grid(True, linestyle='--', alpha=0.3)
-plt.legend()
+ax_pdf.set_title("Distribution of First Passage Times")
+ax_pdf.set_xlabel("Time t")
+ax_pdf.set_ylabel("Density")
+ax_pdf.grid(True, linestyle='--', alpha=0.3)
+ax_pdf.legend()
+
+ax_surv.semilogy(edges, survival, color='#ff7f0e', linewidth=2.0, label='Simulation')
+ax_surv.semilogy(edges[1:], survival_tau(edges[1:]), 'k--', linewidth=1.5, label='Theoretical S(t)')
+ax_surv.set_title("Survival Probability")
+ax_surv.set_xlabel("Time t")
+ax_surv.set_ylabel("P(tau > t)")
+ax_surv.grid(True, which="both", linestyle='--', alpha=0.3)
+ax_surv.legend()
 
 plt.tight_layout()
-plt.savefig("data/escape_plot.png", dpi=150)
+plt.savefig("data/escape_plot.png", dpi=150)
\ No newline at end of file